@@ -31,6 +31,7 @@
 int main()
 {
   try {
+							/* anchor 1 */
     typedef QLinkedList<QtLua::String> Container;
 
     // QLinkedlist we want to access from lua
@@ -48,8 +49,17 @@ int main()
     // Set a value in QLinkedlist directly
     linkedlist << "foo" << "bar" << "FOO";
 
+    // Append, modify and delete entries from lua
+    state.exec_statements("linkedlist[#linkedlist + 1] = \"BAR\"");
+    state.exec_statements("linkedlist[1] = linkedlist[1]..linkedlist[2]");
+    state.exec_statements("linkedlist[3] = nil");
+
+    // Sequential indexed access reuses the cached list position
+    state.exec_statements("for i = 1, #linkedlist do print(i, linkedlist[i]) end");
+
     // Iterate through QLinkedlist from lua script
     state.exec_statements("for key, value in each(linkedlist) do print(key, value) end");
+							/* anchor end */
 
   } catch (QtLua::String &e) {
     std::cerr << e.constData() << std::endl;
@@ -0,0 +1,79 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+// This example show how to use a RecordArrayProxy object to access
+// a QVector of C++ structures from lua script.
+
+#include <iostream>
+
+#include <QVector>
+
+#include <QtLua/State>
+#include <QtLua/RecordArrayProxy>
+
+							/* anchor 1 */
+struct Sample
+{
+  double time;
+  double value;
+  int flags;
+
+  QTLUA_RECORD(Sample)
+};
+
+QTLUA_RECORD_FIELDS(Sample,
+  QTLUA_RECORD_FIELD(Sample, time, double),
+  QTLUA_RECORD_FIELD(Sample, value, double),
+  QTLUA_RECORD_FIELD(Sample, flags, int))
+							/* anchor end */
+
+int main()
+{
+  try {
+    QVector<Sample> samples(100);
+
+    for (int i = 0; i < samples.size(); i++)
+      {
+	samples[i].time = i * 0.1;
+	samples[i].value = i % 10;
+	samples[i].flags = 0;
+      }
+
+    QtLua::RecordArrayProxy<Sample> proxy(samples);
+
+    QtLua::State state;
+    state.openlib(QtLua::QtLuaLib);
+
+    state["samples"] = proxy;
+
+    // Access fields of a single record
+    state.exec_statements("samples[5].flags = 1 print(samples[5].time, samples[5].value)");
+
+    // Access a column of all records as a numeric buffer
+    state.exec_statements("print(samples:column(\"value\"):sum())");
+
+    std::cout << samples[4].flags << std::endl;
+
+  } catch (QtLua::String &e) {
+    std::cerr << e.constData() << std::endl;
+  }
+
+}
+
@@ -0,0 +1,48 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#include <iostream>
+
+#include <QtLua/State>
+
+#include "bindgen.hh"
+
+int main()
+{
+  try {
+
+    QtLua::State state;
+    state.openlib(QtLua::QtLuaLib);
+
+    // register bound member functions generated by qtluabind
+    Vector::qtlua_register(state);
+
+    state["v"] = QTLUA_REFNEW(Vector, 3, 4);
+
+    state.exec_statements("v.x = 6 v:scale(0.5) print(v.x, v.y, v.dimension, v:dot(1, 1))");
+
+  } catch (QtLua::String &e) {
+    std::cerr << e.constData() << std::endl;
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,58 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef BINDGEN_HH_
+#define BINDGEN_HH_
+
+#include <QtLua/UserData>
+#include <QtLua/Bind>
+
+								/* anchor 1 */
+class Vector : public QtLua::UserData
+{
+  QTLUA_BIND_CLASS(Vector)
+
+public:
+  Vector(double x, double y)
+    : x(x), y(y), dimension(2)
+  {
+  }
+
+  QTLUA_BIND double x;
+  QTLUA_BIND double y;
+
+  QTLUA_BIND_RO int dimension;
+
+  QTLUA_BIND double dot(double vx, double vy) const
+  {
+    return x * vx + y * vy;
+  }
+
+  QTLUA_BIND void scale(double f)
+  {
+    x *= f;
+    y *= f;
+  }
+};
+/* anchor end */
+
+#endif
+
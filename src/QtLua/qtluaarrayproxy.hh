@@ -25,6 +25,7 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluaproxymethod.hh"
 
 namespace QtLua {
 
@@ -37,6 +38,9 @@ namespace QtLua {
    * for read access. The @ref ArrayProxy class may be used for
    * read/write access.
    *
+   * The @tt{proxy:slice(i, j)} lua method returns a lua table with
+   * entries in the inclusive range.
+   *
    * See @ref ArrayProxy class documentation for details and examples.
    */
 
@@ -56,6 +60,7 @@ public:
 
   Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
   Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
   bool meta_contains(State &ls, const Value &key);
   Ref<Iterator> new_iterator(State &ls);
   bool support(Value::Operation c) const;
@@ -86,7 +91,11 @@ private:
     unsigned int _it;
   };
 
+  static const typename ProxyMethod<ArrayProxyRo>::Entry _methods[];
+
 protected:
+  Value::List method_slice(State &ls, const Value::List &args);
+
   const T *_array;
   unsigned int _size;
 };
@@ -111,6 +120,17 @@ protected:
    * Lua operator @tt # returns the array size. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Ranges of entries can be accessed in a single call with the
+   * following lua methods:
+   * @list
+   *   @item @tt{proxy:slice(i, j)} returns a lua table with entries in range,
+   *   @item @tt{proxy:assign(i, table)} copies table entries starting at index @tt i,
+   *   @item @tt{proxy:fill(v, i, j)} sets all entries in range to @tt v.
+   * @end list
+   * Ranges are inclusive and default to the whole array.
+   * String keys are only used to look up methods: reading an
+   * unknown name gives @tt nil instead of an index conversion error.
+   *
    * The following example show how anarray can be
    * accessed from both C++ and lua script directly:
    *
@@ -134,8 +154,16 @@ public:
   /** Attach or detach associated array. argument may be NULL */
   void set_container(T *array, unsigned int size);
 
+  Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
   void meta_newindex(State &ls, const Value &key, const Value &value);
-  bool support(enum Value::Operation c);
+  bool support(enum Value::Operation c) const;
+
+private:
+  Value::List method_assign(State &ls, const Value::List &args);
+  Value::List method_fill(State &ls, const Value::List &args);
+
+  static const typename ProxyMethod<ArrayProxy>::Entry _methods[];
 };
 
 }
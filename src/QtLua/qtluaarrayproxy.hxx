@@ -23,6 +23,7 @@
 
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluaproxymethod.hxx"
 
 namespace QtLua {
 
@@ -65,9 +66,31 @@ namespace QtLua {
     _size = size;
   }
 
+  template <class T>
+  const typename ProxyMethod<ArrayProxyRo<T> >::Entry ArrayProxyRo<T>::_methods[] = {
+    { "slice", &ArrayProxyRo::method_slice },
+    { 0, 0 }
+  };
+
+  template <class T>
+  const typename ProxyMethod<ArrayProxy<T> >::Entry ArrayProxy<T>::_methods[] = {
+    { "assign", &ArrayProxy::method_assign },
+    { "fill", &ArrayProxy::method_fill },
+    { "slice", &ArrayProxy::method_slice },
+    { 0, 0 }
+  };
+
   template <class T>
   Value ArrayProxyRo<T>::meta_index(State &ls, const Value &key)
   { 
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<ArrayProxyRo>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  meta_index_cache(ls, key, m);
+	return m;
+      }
+
     if (!_array)
       return Value(ls);
 
@@ -79,16 +102,40 @@ namespace QtLua {
       return Value(ls);
   }
 
+  template <class T>
+  bool ArrayProxyRo<T>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() == Value::TString)
+      {
+	value = meta_index(ls, key);
+	return !value.is_nil();
+      }
+
+    double n;
+
+    if (!_array || !key.try_to_number(n))
+      return false;
+
+    unsigned int index = (unsigned int)n - 1;
+
+    if (index >= _size)
+      return false;
+
+    value = Value(ls, _array[index]);
+    return true;
+  }
+
   template <class T>
   bool ArrayProxyRo<T>::meta_contains(State &ls, const Value &key)
   {
-    try {
-      unsigned int index = (unsigned int)key.to_number() - 1;
+    double n;
 
-      return index < _size;
-    } catch (String &e) {
+    if (!_array || !key.try_to_number(n))
       return false;
-    }
+
+    unsigned int index = (unsigned int)n - 1;
+
+    return index < _size;
   }
 
   template <class T>
@@ -121,7 +168,7 @@ namespace QtLua {
   }
 
   template <class T>
-  bool ArrayProxy<T>::support(enum Value::Operation c)
+  bool ArrayProxy<T>::support(enum Value::Operation c) const
   {
     switch (c)
       {
@@ -142,6 +189,66 @@ namespace QtLua {
     return type_name<T>() + "[" + String::number(_size) + "]";
   }
 
+  template <class T>
+  Value ArrayProxy<T>::meta_index(State &ls, const Value &key)
+  { 
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<ArrayProxy>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  this->meta_index_cache(ls, key, m);
+	return m;
+      }
+
+    return ArrayProxyRo<T>::meta_index(ls, key);
+  }
+
+  template <class T>
+  bool ArrayProxy<T>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() == Value::TString)
+      {
+	value = meta_index(ls, key);
+	return !value.is_nil();
+      }
+
+    return ArrayProxyRo<T>::meta_find(ls, key, value);
+  }
+
+  template <class T>
+  Value::List ArrayProxyRo<T>::method_slice(State &ls, const Value::List &args)
+  {
+    if (!_array)
+      throw String("Can not read from null array.");
+
+    return ProxyMethodBase::slice(ls, _array, _size, args);
+  }
+
+  template <class T>
+  Value::List ArrayProxy<T>::method_fill(State &ls, const Value::List &args)
+  {
+    if (!_array)
+      throw String("Can not write to null array.");
+
+    T *array = const_cast<T*>(_array);
+    ProxyMethodBase::fill(array, _size, args);
+    return Value::List();
+  }
+
+  template <class T>
+  Value::List ArrayProxy<T>::method_assign(State &ls, const Value::List &args)
+  {
+    if (!_array)
+      throw String("Can not write to null array.");
+
+    T *array = const_cast<T*>(_array);
+    QVector<T> values;
+    int first = ProxyMethodBase::assign_values(args, values);
+
+    ProxyMethodBase::assign(array, _size, first, values);
+    return Value::List();
+  }
+
   template <class T>
   void ArrayProxy<T>::meta_newindex(State &ls, const Value &key, const Value &value)
   {
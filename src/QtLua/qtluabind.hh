@@ -0,0 +1,257 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef QTLUABIND_HH_
+#define QTLUABIND_HH_
+
+#include <QString>
+
+#include "qtluastring.hh"
+#include "qtluavalue.hh"
+
+struct lua_State;
+
+namespace QtLua {
+
+  class State;
+
+  /**
+   * @short Native C++ functions binding helpers
+   * @header QtLua/Bind
+   * @module {Functions export}
+   *
+   * This class contains low level stack access functions used by
+   * the @ref __bind__ and @ref __bind_method__ templates. These
+   * templates generate a native lua C function for a given C++
+   * function pointer. Arguments are converted straight from lua
+   * stack slots and the argument count is fixed at compile time,
+   * no @ref Value::List is built on call.
+   *
+   * Conversion of a given C++ type is performed by the @ref
+   * BindType class template which may be specialized for user
+   * types. Arithmetic types, @ref String, @ref QString, @tt{const
+   * char *} and @ref Value are handled directly; other types are
+   * converted through a @ref Value object.
+   *
+   * Up to 6 arguments are supported.
+   */
+  class BindBase
+  {
+  public:
+    /** Native function pointer type */
+    typedef int (*cfunction_t)(lua_State *st);
+
+    /** Create a native closure holding a copy of @tt data and
+	register it at given path in @ref State. */
+    static void register_(State &ls, const String &path, cfunction_t f,
+			  const void *data, size_t size);
+
+    /** Copy closure data to @tt data. */
+    static void get_data(lua_State *st, void *data, size_t size);
+
+    /** Throw if number of arguments on stack is not @tt count. The
+	@tt self slots before the first argument are not included in
+	@tt count nor in the error message. */
+    static void check_count(lua_State *st, int count, int self = 0);
+
+    /** Raise a lua error from an exception message. */
+    static void error(lua_State *st, const String &e);
+
+    /** Get @ref State object associated with current closure. */
+    static State & state(lua_State *st);
+
+    static double to_number(lua_State *st, int i);
+    static bool to_boolean(lua_State *st, int i);
+    static const char * to_cstring(lua_State *st, int i);
+    static String to_string(lua_State *st, int i);
+    static Value to_value(lua_State *st, int i);
+
+    /** Get object passed as first stack slot of a bound method call
+	without building a @ref Value. Throw if the argument is not
+	a @ref UserData object of type @tt C. */
+    template <class C>
+    static inline C * to_self(lua_State *st);
+
+    static void push_number(lua_State *st, double n);
+    static void push_boolean(lua_State *st, bool b);
+    static void push_cstring(lua_State *st, const char *s);
+    static void push_string(lua_State *st, const char *s, int len);
+    static void push_value(lua_State *st, const Value &v);
+
+    /** Get lua stack of a @ref State. */
+    static lua_State * stack(State &ls);
+    /** Push a new table with preallocated array part. */
+    static void new_table(lua_State *st, int array_size);
+    /** Pop value and store it at integer key @tt n of the table on
+	top of stack, without invoking metamethods. */
+    static void raw_seti(lua_State *st, int n);
+    /** Pop value on top of stack. */
+    static Value pop_value(State &ls);
+
+    /** Binary search of a string key in a sorted names table. Used
+	by code generated with the @tt qtluabind tool. @return entry
+	index or -1. */
+    static int lookup(const char * const *names, int count, const Value &key);
+
+    /** Create a native closure holding a copy of @tt data and store
+	it as @tt name entry of the members table associated with @tt
+	class_key in the lua registry. */
+    static void register_member(State &ls, const void *class_key, const char *name,
+				cfunction_t f, const void *data, size_t size);
+
+    /** Get entry of the members table associated with @tt
+	class_key. Used by code generated with the @tt qtluabind tool
+	to fetch methods. Throw if no members have been registered. */
+    static Value class_member(State &ls, const void *class_key, const Value &key);
+
+    /** Same as @ref class_member but return @tt false instead of
+	throwing when no members have been registered or the entry
+	is nil. */
+    static bool find_class_member(State &ls, const void *class_key,
+				  const Value &key, Value &value);
+
+  private:
+    static UserData * to_userdata(lua_State *st, int i);
+  };
+
+  /**
+   * @short Lua stack conversion traits for bound functions
+   * @header QtLua/Bind
+   * @module {Functions export}
+   *
+   * This class template defines how a C++ type is read from and
+   * pushed to the lua stack by functions registered with @ref
+   * __bind__. The default implementation relies on @ref Value
+   * conversion functions and may be specialized for user types.
+   */
+  template <class X>
+  struct BindType
+  {
+    /** Read stack slot @tt i as an @tt X value. */
+    static inline X get(lua_State *st, int i);
+    /** Push @tt X value on lua stack. */
+    static inline void push(lua_State *st, const X &x);
+  };
+
+  template <class X>
+  struct BindType<const X &> : public BindType<X> {};
+
+  template <class X>
+  struct BindType<const X> : public BindType<X> {};
+
+  template <class X>
+  struct BindType<X &> : public BindType<X> {};
+
+  /**
+   * @alias bind
+   * This function registers a C++ function pointer in the lua global
+   * table or in package subtables. Argument and return values are
+   * converted using the @ref BindType class template.
+   *
+   * @param ls QtLua state where function must be registered.
+   * @param path table path to function value.
+   * @param f pointer to function.
+   */
+  template <class F>
+  void bind(State &ls, const String &path, F f);
+
+  /**
+   * @alias bind_method
+   * This function registers a C++ member function pointer in the lua
+   * global table or in package subtables. The class must inherit
+   * from @ref UserData and the object is expected as first argument,
+   * as done by the lua @tt{obj:method()} call syntax.
+   *
+   * @param ls QtLua state where function must be registered.
+   * @param path table path to function value.
+   * @param m pointer to member function.
+   */
+  template <class M>
+  void bind_method(State &ls, const String &path, M m);
+
+  /**
+   * @alias bind_member
+   * This function registers a C++ function or member function
+   * pointer in a members table private to a class instead of the lua
+   * global table. The table is stored in the lua registry and
+   * identified by the address @tt class_key. Entries are retrieved
+   * with @ref BindBase::class_member. This is used by code generated
+   * with the @tt qtluabind tool.
+   *
+   * @param ls QtLua state where function must be registered.
+   * @param class_key address identifying the members table.
+   * @param name entry name in members table.
+   * @param f pointer to function or member function.
+   */
+  template <class F>
+  void bind_member(State &ls, const void *class_key, const char *name, F f);
+
+  /**
+   * Member annotation for the @tt qtluabind code generator, expands
+   * to nothing. Put it in front of a data member or member function
+   * declaration in a class which uses @ref #QTLUA_BIND_CLASS to
+   * make the member accessible from lua.
+   */
+#define QTLUA_BIND
+
+  /**
+   * Read only member annotation for the @tt qtluabind code
+   * generator, expands to nothing.
+   * @see #QTLUA_BIND
+   */
+#define QTLUA_BIND_RO
+
+  /**
+   * This macro must appear in the body of a @ref UserData based
+   * class processed by the @tt qtluabind code generator. It declares
+   * the table access functions and the @tt qtlua_register static
+   * function which are defined by generated code. Access
+   * specifier is @tt private after this macro.
+   *
+   * The generator reads the annotated header and writes a C++ file
+   * where bound data members are read and written directly and
+   * bound member functions are registered as native lua functions
+   * using @ref __bind_member__ in a members table private to the
+   * class, stored in the lua registry. The @tt qtlua_register
+   * function must be called once for each @ref State object. Member
+   * functions are cached in the object metatable on first access.
+   * Overloaded functions are not supported.
+   *
+   * The fully qualified class name must be used when the class is
+   * declared in a namespace.
+   *
+   * @example examples/cpp/userdata/bindgen.hh:1
+   */
+#define QTLUA_BIND_CLASS(class_name)					\
+  public:								\
+    static void qtlua_register(QtLua::State &ls);			\
+    QtLua::Value meta_index(QtLua::State &ls, const QtLua::Value &key); \
+    bool meta_find(QtLua::State &ls, const QtLua::Value &key, QtLua::Value &value); \
+    bool meta_contains(QtLua::State &ls, const QtLua::Value &key);	\
+    void meta_newindex(QtLua::State &ls, const QtLua::Value &key,	\
+		       const QtLua::Value &value);			\
+    bool support(QtLua::Value::Operation c) const;			\
+  private:
+
+}
+
+#endif
+
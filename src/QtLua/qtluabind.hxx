@@ -0,0 +1,336 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef QTLUABIND_HXX_
+#define QTLUABIND_HXX_
+
+#include "qtluastring.hxx"
+#include "qtluavalue.hxx"
+
+namespace QtLua {
+
+  template <class C>
+  C * BindBase::to_self(lua_State *st)
+  {
+    C *self = dynamic_cast<C*>(to_userdata(st, 1));
+
+    if (!self)
+      throw String("Wrong type for method object, % expected.")
+	.arg(UserData::type_name<C>());
+
+    return self;
+  }
+
+  template <class X>
+  X BindType<X>::get(lua_State *st, int i)
+  {
+    return BindBase::to_value(st, i);
+  }
+
+  template <class X>
+  void BindType<X>::push(lua_State *st, const X &x)
+  {
+    BindBase::push_value(st, Value(BindBase::state(st), x));
+  }
+
+#define QTLUA_BIND_NUMBER(type)						\
+  template <>								\
+  struct BindType<type>							\
+  {									\
+    static inline type get(lua_State *st, int i)			\
+    {									\
+      return (type)BindBase::to_number(st, i);				\
+    }									\
+									\
+    static inline void push(lua_State *st, type x)			\
+    {									\
+      BindBase::push_number(st, (double)x);				\
+    }									\
+  };
+
+  QTLUA_BIND_NUMBER(char)
+  QTLUA_BIND_NUMBER(signed char)
+  QTLUA_BIND_NUMBER(unsigned char)
+  QTLUA_BIND_NUMBER(short)
+  QTLUA_BIND_NUMBER(unsigned short)
+  QTLUA_BIND_NUMBER(int)
+  QTLUA_BIND_NUMBER(unsigned int)
+  QTLUA_BIND_NUMBER(long)
+  QTLUA_BIND_NUMBER(unsigned long)
+  QTLUA_BIND_NUMBER(float)
+  QTLUA_BIND_NUMBER(double)
+
+#undef QTLUA_BIND_NUMBER
+
+  template <>
+  struct BindType<bool>
+  {
+    static inline bool get(lua_State *st, int i)
+    {
+      return BindBase::to_boolean(st, i);
+    }
+
+    static inline void push(lua_State *st, bool x)
+    {
+      BindBase::push_boolean(st, x);
+    }
+  };
+
+  template <>
+  struct BindType<const char *>
+  {
+    static inline const char * get(lua_State *st, int i)
+    {
+      // string stays on the stack until the bound function returns
+      return BindBase::to_cstring(st, i);
+    }
+
+    static inline void push(lua_State *st, const char *x)
+    {
+      BindBase::push_cstring(st, x);
+    }
+  };
+
+  template <>
+  struct BindType<String>
+  {
+    static inline String get(lua_State *st, int i)
+    {
+      return BindBase::to_string(st, i);
+    }
+
+    static inline void push(lua_State *st, const String &x)
+    {
+      BindBase::push_string(st, x.constData(), x.size());
+    }
+  };
+
+  template <>
+  struct BindType<QString>
+  {
+    static inline QString get(lua_State *st, int i)
+    {
+      return BindBase::to_string(st, i).to_qstring();
+    }
+
+    static inline void push(lua_State *st, const QString &x)
+    {
+      String s(x);
+      BindBase::push_string(st, s.constData(), s.size());
+    }
+  };
+
+  template <>
+  struct BindType<Value>
+  {
+    static inline Value get(lua_State *st, int i)
+    {
+      return BindBase::to_value(st, i);
+    }
+
+    static inline void push(lua_State *st, const Value &x)
+    {
+      BindBase::push_value(st, x);
+    }
+  };
+
+  /** @internal Native call wrapper, specialized for each supported
+      function pointer type. */
+  template <class F>
+  struct BindCall;
+
+  // Template parameter lists, parameter types and stack reads for
+  // 0 to 6 arguments. Stack index of first argument is o + 1.
+
+#define QTLUA_BIND_TPL_0
+#define QTLUA_BIND_TPL_1 , class A1
+#define QTLUA_BIND_TPL_2 , class A1, class A2
+#define QTLUA_BIND_TPL_3 , class A1, class A2, class A3
+#define QTLUA_BIND_TPL_4 , class A1, class A2, class A3, class A4
+#define QTLUA_BIND_TPL_5 , class A1, class A2, class A3, class A4, class A5
+#define QTLUA_BIND_TPL_6 , class A1, class A2, class A3, class A4, class A5, class A6
+
+#define QTLUA_BIND_VTPL_0
+#define QTLUA_BIND_VTPL_1 class A1
+#define QTLUA_BIND_VTPL_2 class A1, class A2
+#define QTLUA_BIND_VTPL_3 class A1, class A2, class A3
+#define QTLUA_BIND_VTPL_4 class A1, class A2, class A3, class A4
+#define QTLUA_BIND_VTPL_5 class A1, class A2, class A3, class A4, class A5
+#define QTLUA_BIND_VTPL_6 class A1, class A2, class A3, class A4, class A5, class A6
+
+#define QTLUA_BIND_ARGS_0
+#define QTLUA_BIND_ARGS_1 A1
+#define QTLUA_BIND_ARGS_2 A1, A2
+#define QTLUA_BIND_ARGS_3 A1, A2, A3
+#define QTLUA_BIND_ARGS_4 A1, A2, A3, A4
+#define QTLUA_BIND_ARGS_5 A1, A2, A3, A4, A5
+#define QTLUA_BIND_ARGS_6 A1, A2, A3, A4, A5, A6
+
+#define QTLUA_BIND_GET(n) BindType<A##n>::get(st, o + n)
+
+#define QTLUA_BIND_GET_0
+#define QTLUA_BIND_GET_1 QTLUA_BIND_GET(1)
+#define QTLUA_BIND_GET_2 QTLUA_BIND_GET_1, QTLUA_BIND_GET(2)
+#define QTLUA_BIND_GET_3 QTLUA_BIND_GET_2, QTLUA_BIND_GET(3)
+#define QTLUA_BIND_GET_4 QTLUA_BIND_GET_3, QTLUA_BIND_GET(4)
+#define QTLUA_BIND_GET_5 QTLUA_BIND_GET_4, QTLUA_BIND_GET(5)
+#define QTLUA_BIND_GET_6 QTLUA_BIND_GET_5, QTLUA_BIND_GET(6)
+
+  // call body, o is the number of stack slots before first argument
+#define QTLUA_BIND_BODY(n, o_, call, ret)				\
+  static int call_(lua_State *st)					\
+  {									\
+    const int o = o_;							\
+    try {								\
+      BindBase::check_count(st, n, o);					\
+      F f;								\
+      BindBase::get_data(st, &f, sizeof(f));				\
+      ret(call);							\
+    } catch (String &e) {						\
+      BindBase::error(st, e);						\
+    }									\
+    return 0;								\
+  }
+
+#define QTLUA_BIND_RET_VALUE(call)					\
+  BindType<R>::push(st, call);						\
+  return 1;
+
+#define QTLUA_BIND_RET_VOID(call)					\
+  call;									\
+  return 0;
+
+#define QTLUA_BIND_SELF(C)						\
+  BindBase::to_self<C>(st)
+
+#define QTLUA_BIND_SPECS(n)						\
+									\
+  template <class R QTLUA_BIND_TPL_##n>					\
+  struct BindCall<R (*)(QTLUA_BIND_ARGS_##n)>				\
+  {									\
+    typedef R (*F)(QTLUA_BIND_ARGS_##n);				\
+    QTLUA_BIND_BODY(n, 0, f(QTLUA_BIND_GET_##n), QTLUA_BIND_RET_VALUE)	\
+  };									\
+									\
+  template <QTLUA_BIND_VTPL_##n>					\
+  struct BindCall<void (*)(QTLUA_BIND_ARGS_##n)>			\
+  {									\
+    typedef void (*F)(QTLUA_BIND_ARGS_##n);				\
+    QTLUA_BIND_BODY(n, 0, f(QTLUA_BIND_GET_##n), QTLUA_BIND_RET_VOID)	\
+  };									\
+									\
+  template <class C, class R QTLUA_BIND_TPL_##n>			\
+  struct BindCall<R (C::*)(QTLUA_BIND_ARGS_##n)>			\
+  {									\
+    typedef R (C::*F)(QTLUA_BIND_ARGS_##n);				\
+    QTLUA_BIND_BODY(n, 1, (QTLUA_BIND_SELF(C)->*f)(QTLUA_BIND_GET_##n), \
+		    QTLUA_BIND_RET_VALUE)				\
+  };									\
+									\
+  template <class C QTLUA_BIND_TPL_##n>					\
+  struct BindCall<void (C::*)(QTLUA_BIND_ARGS_##n)>			\
+  {									\
+    typedef void (C::*F)(QTLUA_BIND_ARGS_##n);				\
+    QTLUA_BIND_BODY(n, 1, (QTLUA_BIND_SELF(C)->*f)(QTLUA_BIND_GET_##n), \
+		    QTLUA_BIND_RET_VOID)				\
+  };									\
+									\
+  template <class C, class R QTLUA_BIND_TPL_##n>			\
+  struct BindCall<R (C::*)(QTLUA_BIND_ARGS_##n) const>			\
+  {									\
+    typedef R (C::*F)(QTLUA_BIND_ARGS_##n) const;			\
+    QTLUA_BIND_BODY(n, 1, (QTLUA_BIND_SELF(C)->*f)(QTLUA_BIND_GET_##n), \
+		    QTLUA_BIND_RET_VALUE)				\
+  };									\
+									\
+  template <class C QTLUA_BIND_TPL_##n>					\
+  struct BindCall<void (C::*)(QTLUA_BIND_ARGS_##n) const>		\
+  {									\
+    typedef void (C::*F)(QTLUA_BIND_ARGS_##n) const;			\
+    QTLUA_BIND_BODY(n, 1, (QTLUA_BIND_SELF(C)->*f)(QTLUA_BIND_GET_##n), \
+		    QTLUA_BIND_RET_VOID)				\
+  };
+
+  QTLUA_BIND_SPECS(0)
+  QTLUA_BIND_SPECS(1)
+  QTLUA_BIND_SPECS(2)
+  QTLUA_BIND_SPECS(3)
+  QTLUA_BIND_SPECS(4)
+  QTLUA_BIND_SPECS(5)
+  QTLUA_BIND_SPECS(6)
+
+#undef QTLUA_BIND_SPECS
+#undef QTLUA_BIND_SELF
+#undef QTLUA_BIND_RET_VOID
+#undef QTLUA_BIND_RET_VALUE
+#undef QTLUA_BIND_BODY
+#undef QTLUA_BIND_GET
+#undef QTLUA_BIND_GET_0
+#undef QTLUA_BIND_GET_1
+#undef QTLUA_BIND_GET_2
+#undef QTLUA_BIND_GET_3
+#undef QTLUA_BIND_GET_4
+#undef QTLUA_BIND_GET_5
+#undef QTLUA_BIND_GET_6
+#undef QTLUA_BIND_ARGS_0
+#undef QTLUA_BIND_ARGS_1
+#undef QTLUA_BIND_ARGS_2
+#undef QTLUA_BIND_ARGS_3
+#undef QTLUA_BIND_ARGS_4
+#undef QTLUA_BIND_ARGS_5
+#undef QTLUA_BIND_ARGS_6
+#undef QTLUA_BIND_VTPL_0
+#undef QTLUA_BIND_VTPL_1
+#undef QTLUA_BIND_VTPL_2
+#undef QTLUA_BIND_VTPL_3
+#undef QTLUA_BIND_VTPL_4
+#undef QTLUA_BIND_VTPL_5
+#undef QTLUA_BIND_VTPL_6
+#undef QTLUA_BIND_TPL_0
+#undef QTLUA_BIND_TPL_1
+#undef QTLUA_BIND_TPL_2
+#undef QTLUA_BIND_TPL_3
+#undef QTLUA_BIND_TPL_4
+#undef QTLUA_BIND_TPL_5
+#undef QTLUA_BIND_TPL_6
+
+  template <class F>
+  void bind(State &ls, const String &path, F f)
+  {
+    BindBase::register_(ls, path, &BindCall<F>::call_, &f, sizeof(f));
+  }
+
+  template <class M>
+  void bind_method(State &ls, const String &path, M m)
+  {
+    BindBase::register_(ls, path, &BindCall<M>::call_, &m, sizeof(m));
+  }
+
+  template <class F>
+  void bind_member(State &ls, const void *class_key, const char *name, F f)
+  {
+    BindBase::register_member(ls, class_key, name, &BindCall<F>::call_, &f, sizeof(f));
+  }
+
+}
+
+#endif
+
@@ -0,0 +1,110 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUABYTEBUFFER_HH_
+#define QTLUABYTEBUFFER_HH_
+
+#include <QByteArray>
+
+#include "qtluauserdata.hh"
+#include "qtluaproxymethod.hh"
+
+namespace QtLua {
+
+  /**
+   * @short Lua byte buffer sharing @ref QByteArray data
+   * @header QtLua/ByteBuffer
+   * @module {Base}
+   *
+   * This class may be used to expose a @ref QByteArray to lua script
+   * without copying its content into a lua string. The object holds
+   * an implicitly shared copy of the byte array; bytes are converted
+   * only when accessed from lua.
+   *
+   * First byte has index 1. Lua @tt nil value is returned if index
+   * is out of bounds. Lua operator @tt # returns the buffer size and
+   * the unary minus operator returns a lua string copy.
+   *
+   * The following lua methods are available, indices follow the lua
+   * string library rules and may be negative:
+   * @list
+   *   @item @tt{buf:byte(i, j)} returns byte values like @tt string.byte.
+   *   @item @tt{buf:sub(i, j)} returns a new @ref ByteBuffer object
+   *     sharing the same data, no bytes are copied.
+   *   @item @tt{buf:find(s, init)} returns the index of the first
+   *     occurrence of a plain string or buffer @tt s or @tt nil.
+   *   @item @tt{buf:tostring(i, j)} returns a lua string copy.
+   * @end list
+   *
+   * @ref QByteArray values of @ref QObject properties and slot
+   * arguments are exposed as @ref ByteBuffer objects when the @ref
+   * State::ConvertByteBuffers conversion flag is set. @ref ByteBuffer
+   * objects are always accepted back on conversion to @ref QByteArray.
+   */
+
+class ByteBuffer : public UserData
+{
+public:
+  QTLUA_REFTYPE(ByteBuffer);
+
+  /** Create a @ref ByteBuffer object sharing data with @tt data */
+  ByteBuffer(const QByteArray &data);
+
+  /** Get buffer data */
+  inline const QByteArray & get_data() const;
+
+  /** Get buffer size */
+  inline int size() const;
+
+  /** Get buffer data if @tt v holds a @ref ByteBuffer object. */
+  static bool get(const Value &v, QByteArray &data);
+
+  Value meta_index(State &ls, const Value &key);
+  bool meta_contains(State &ls, const Value &key);
+  Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
+  bool support(Value::Operation c) const;
+
+private:
+
+  ByteBuffer(const QByteArray &owner, int pos, int len);
+
+  String get_type_name() const;
+  String get_value_str() const;
+
+  void get_range(const Value::List &args, int n, int &first, int &last) const;
+
+  Value::List method_byte(State &ls, const Value::List &args);
+  Value::List method_find(State &ls, const Value::List &args);
+  Value::List method_sub(State &ls, const Value::List &args);
+  Value::List method_tostring(State &ls, const Value::List &args);
+
+  static const ProxyMethod<ByteBuffer>::Entry _methods[];
+
+  /** keeps shared data alive when @tt _data is a raw sub range */
+  QByteArray _owner;
+  QByteArray _data;
+};
+
+}
+
+#endif
+
@@ -21,6 +21,9 @@
 #ifndef QTLUADISPATCHPROXY_HH_
 #define QTLUADISPATCHPROXY_HH_
 
+#include <QHash>
+#include <QByteArray>
+
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
 
@@ -43,6 +46,22 @@ namespace QtLua {
    * See @xref{Members detail} section for details about behavior of
    * different operations.
    *
+   * Table read accesses query each target in turn until a non @tt
+   * nil value is found. A target which does not contain the key,
+   * holds a @tt nil value or throws on read does not hide later
+   * targets.
+   *
+   * An optional routing cache can be enabled with the @ref
+   * set_route_cache function. It remembers which target handled a
+   * string key on table read and write accesses, so that later
+   * accesses with the same key go straight to that target. A cached
+   * route which misses is dropped and the targets are queried
+   * again. The cache is also dropped when targets are added or
+   * removed. A cached route takes precedence over earlier targets:
+   * the @ref invalidate_routes function must be called when entries
+   * are added to a target which may shadow entries of a later
+   * target.
+   *
    * @example examples/cpp/proxy/dispatchproxy_string.cc:1|2
    */
 
@@ -65,8 +84,10 @@ public:
    * from a specific class in @ref UserData inheritance tree. When this
    * feature is used, a reimplementation of the @ref
    * UserData::meta_contains function must be available in the same class
-   * if either the @ref UserData::meta_index function or the @ref
-   * UserData::meta_newindex function is reimplemented.
+   * if the @ref UserData::meta_newindex function is reimplemented.
+   * Table reads rely on the @ref UserData::meta_find function of the
+   * class when reimplemented, or else on the @ref
+   * UserData::meta_contains and @ref UserData::meta_index functions.
    */
   template <class T>
   unsigned int add_target(T *t, Value::Operations mask = Value::OpAll,
@@ -87,6 +108,12 @@ public:
   template <class T>
   void remove_target(T *t);
 
+  /** Enable or disable the routing cache. Cache is disabled by default. */
+  void set_route_cache(bool enabled);
+
+  /** Drop all cached routes. */
+  void invalidate_routes();
+
   /** 
    * This function handles the requested operation by relying on the
    * first registered object which @ref UserData::support {supports}
@@ -129,6 +156,13 @@ public:
    */
   bool meta_contains(State &ls, const Value &key);
 
+  /**
+   * This function performs the same lookup as @ref meta_index but
+   * returns @tt false instead of falling back to the default
+   * implementation when no registered object contains the key.
+   */
+  bool meta_find(State &ls, const Value &key, Value &value);
+
   /** 
    * This function handles the @ref Value::OpCall operation by relying
    * on the first registered object which @ref UserData::support
@@ -163,6 +197,7 @@ private:
     virtual Value _meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b) const = 0;
     virtual Value _meta_index(State &ls, const Value &key) const = 0;
     virtual bool _meta_contains(State &ls, const Value &key) const = 0;
+    virtual bool _meta_find(State &ls, const Value &key, Value &value) const = 0;
     virtual void _meta_newindex(State &ls, const Value &key, const Value &value) const = 0;
     virtual Value::List _meta_call(State &ls, const Value::List &args) const = 0;
     virtual Ref<Iterator> _new_iterator(State &ls) const = 0;
@@ -185,6 +220,8 @@ private:
     /** @override */
     bool _meta_contains(State &ls, const Value &key) const;
     /** @override */
+    bool _meta_find(State &ls, const Value &key, Value &value) const;
+    /** @override */
     void _meta_newindex(State &ls, const Value &key, const Value &value) const;
     /** @override */
     Value::List _meta_call(State &ls, const Value::List &args) const;
@@ -192,6 +229,12 @@ private:
     Ref<Iterator> _new_iterator(State &ls) const;
     /** @override */
     bool _support(enum Value::Operation c) const;
+
+    template <class C>
+    static inline bool find_entry(T *ud, bool (C::*)(State &, const Value &, Value &),
+				  State &ls, const Value &key, Value &value);
+    static inline bool find_entry(T *ud, bool (UserData::*)(State &, const Value &, Value &),
+				  State &ls, const Value &key, Value &value);
   };
 
   class ProxyIterator : public Iterator
@@ -215,7 +258,16 @@ private:
 
   friend class ProxyIterator;
 
+  typedef QHash<QByteArray, int> routes_t;
+
+  static inline QByteArray route_key(const Value &key);
+  void add_route(routes_t &routes, const QByteArray &key, int index);
+  bool find(State &ls, const Value &key, Value &value, bool &supported);
+
   QList<TargetBase*> _targets;
+  bool _route_cache;
+  routes_t _index_routes;
+  routes_t _newindex_routes;
 
 };
 
@@ -21,6 +21,8 @@
 #ifndef QTLUADISPATCHPROXY_HXX_
 #define QTLUADISPATCHPROXY_HXX_
 
+#include <cstring>
+
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
 
@@ -30,6 +32,7 @@ namespace QtLua {
   unsigned int DispatchProxy::add_target(T *t, Value::Operations mask, bool new_keys)
   {
     _targets.push_back(new Target<T>(t, mask, new_keys)); 
+    invalidate_routes();
     return _targets.size() - 1;
   }
 
@@ -38,6 +41,7 @@ namespace QtLua {
 					    Value::Operations mask, bool new_keys)
   {
     _targets.insert(pos, new Target<T>(t, mask, new_keys)); 
+    invalidate_routes();
     return pos;
   }
 
@@ -52,6 +56,8 @@ namespace QtLua {
 	else
 	  i++;
       }
+
+    invalidate_routes();
   }
 
   DispatchProxy::TargetBase::TargetBase(UserData *ud, Value::Operations ops, bool new_keys)
@@ -85,6 +91,38 @@ namespace QtLua {
     return static_cast<T*>(_ud)->T::meta_contains(ls, key);
   }
 
+  template <class T>
+  bool DispatchProxy::Target<T>::_meta_find(State &ls, const Value &key, Value &value) const
+  {
+    return find_entry(static_cast<T*>(_ud), &T::meta_find, ls, key, value);
+  }
+
+  template <class T>
+  template <class C>
+  bool DispatchProxy::Target<T>::find_entry(T *ud, bool (C::*)(State &, const Value &, Value &),
+					    State &ls, const Value &key, Value &value)
+  {
+    // meta_find reimplemented in class
+    return ud->T::meta_find(ls, key, value);
+  }
+
+  template <class T>
+  bool DispatchProxy::Target<T>::find_entry(T *ud, bool (UserData::*)(State &, const Value &, Value &),
+					    State &ls, const Value &key, Value &value)
+  {
+    // forced class read, UserData::meta_find would call the
+    // virtual meta_index of the most derived class
+    try {
+      if (!ud->T::meta_contains(ls, key))
+	return false;
+
+      value = ud->T::meta_index(ls, key);
+      return !value.is_nil();
+    } catch (String &e) {
+      return false;
+    }
+  }
+
   template <class T>
   void DispatchProxy::Target<T>::_meta_newindex(State &ls, const Value &key, const Value &value) const
   {
@@ -109,6 +147,16 @@ namespace QtLua {
     return static_cast<T*>(_ud)->T::support(c);
   }
 
+  QByteArray DispatchProxy::route_key(const Value &key)
+  {
+    if (key.type() != Value::TString)
+      return QByteArray();
+
+    // no copy, only used for lookup while key is alive
+    const char *s = key.to_cstring();
+    return QByteArray::fromRawData(s, strlen(s));
+  }
+
   DispatchProxy::ProxyIterator::ProxyIterator(State &ls, const DispatchProxy &dp)
     : _state(&ls),
       _dp(dp),
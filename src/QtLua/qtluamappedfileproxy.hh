@@ -0,0 +1,164 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUAMAPPEDFILEPROXY_HH_
+#define QTLUAMAPPEDFILEPROXY_HH_
+
+#include <QFile>
+#include <QPointer>
+#include <QVector>
+
+#include "qtluauserdata.hh"
+#include "qtluaiterator.hh"
+#include "qtluaproxymethod.hh"
+
+namespace QtLua {
+
+  /**
+   * @short Memory mapped file of fixed size records for lua script
+   * @header QtLua/MappedFileProxy
+   * @module {Container proxies}
+   *
+   * This class may be used to expose a large binary file made of
+   * fixed size records to lua script for read access. The file is
+   * mapped in memory using the @ref QFile::map function instead of
+   * being loaded; records are decoded on access only so that memory
+   * use depends on the part of the file actually touched by scripts.
+   *
+   * First record has index 1. Lua @tt nil value is returned if index
+   * is above record count. Lua operator @tt # returns the record
+   * count. The @tt{proxy:slice(i, j)} lua method returns a lua table
+   * of records in the inclusive range.
+   *
+   * Records are decoded in one of the following ways:
+   * @list
+   *   @item A user @ref decoder_t function can be set with @ref set_decoder.
+   *   @item Fields can be declared with @ref add_field along with
+   *     their offset in record and Qt meta type id. Records are then
+   *     returned as lua tables with named entries. Fields are
+   *     converted using the same converters as @ref QObject
+   *     properties, including user registered @ref MetaType
+   *     handlers. Field types must be plain types which can be read
+   *     from raw memory: numbers, @ref QChar and geometry types are
+   *     accepted, user types up to 32 bytes must not hold pointers.
+   *   @item Records are returned as lua strings when no decoder and
+   *     no field have been declared.
+   * @end list
+   *
+   * A single field declared with an empty name is returned directly
+   * instead of being stored in a table.
+   */
+
+class MappedFileProxy : public UserData
+{
+public:
+  QTLUA_REFTYPE(MappedFileProxy);
+
+  /** Record decoder function type, @tt record points to @tt size bytes. */
+  typedef Value (*decoder_t)(State &ls, const uchar *record, int size);
+
+  /** Create a @ref MappedFileProxy object with no mapped file */
+  MappedFileProxy();
+  /** Create a @ref MappedFileProxy object and map given file,
+      @see open */
+  MappedFileProxy(const String &filename, int record_size, qint64 offset = 0);
+  ~MappedFileProxy();
+
+  /** Map a file, any previously mapped file is unmapped. Records
+      start at @tt offset in file, trailing bytes which do not
+      fill a record are ignored. Throw if the file can not be mapped. */
+  void open(const String &filename, int record_size, qint64 offset = 0);
+  /** Unmap file */
+  void close();
+
+  /** Set record decoder function, may be NULL. */
+  void set_decoder(decoder_t decoder);
+  /** Declare a record field with its offset and Qt meta type id.
+      Throw if the type is not a plain number or geometry type, or
+      a registered user type, or if it does not fit in record. */
+  void add_field(const String &name, int offset, int type);
+
+  /** Get number of records */
+  inline int size() const;
+  /** Get pointer to record at given 0 based index */
+  inline const uchar * record(int index) const;
+
+  /** Decode record at given 0 based index */
+  Value decode(State &ls, int index) const;
+
+  Value meta_index(State &ls, const Value &key);
+  bool meta_contains(State &ls, const Value &key);
+  Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
+  Ref<Iterator> new_iterator(State &ls);
+  bool support(Value::Operation c) const;
+
+private:
+
+  String get_type_name() const;
+
+  Value::List method_slice(State &ls, const Value::List &args);
+
+  static const ProxyMethod<MappedFileProxy>::Entry _methods[];
+
+  /**
+   * @short MappedFileProxy iterator class
+   * @internal
+   */
+  class ProxyIterator : public Iterator
+  {
+  public:
+    QTLUA_REFTYPE(ProxyIterator);
+    ProxyIterator(State *ls, const Ref<MappedFileProxy> &proxy);
+
+  private:
+    bool more() const;
+    void next();
+    Value get_key() const;
+    Value get_value() const;
+    ValueRef get_value_ref();
+
+    QPointer<State> _ls;
+    MappedFileProxy::ptr _proxy;
+    int _it;
+  };
+
+  /** @internal Record field entry */
+  struct Field
+  {
+    String _name;
+    int _offset;
+    int _type;
+    int _size;
+  };
+
+  QFile _file;
+  uchar *_data;
+  int _record_size;
+  int _size;
+  decoder_t _decoder;
+  QVector<Field> _fields;
+};
+
+}
+
+#endif
+
@@ -25,7 +25,6 @@
 
 #include <QMetaObject>
 #include <QMetaType>
-#include <QMap>
 
 #include "qtluavalue.hh"
 #include "internal/qtluaqobjectwrapper.hh"
@@ -39,10 +38,11 @@ namespace QtLua {
 
   /** @internal */
   typedef MetaType<void> metatype_void_t;
-  /** @internal */
-  typedef QMap<int, metatype_void_t* > metatype_map_t;
-  /** @internal */
-  extern metatype_map_t types_map;
+  /** @internal Register a conversion handler in the converter
+      table. Throw if a handler is already registered for this type. */
+  void metatype_register(int type, metatype_void_t *mt);
+  /** @internal Remove a conversion handler from the converter table. */
+  void metatype_unregister(int type);
 
   /**
    * @short Register Lua to Qt meta types conversion functions
@@ -72,6 +72,12 @@ namespace QtLua {
    * @ref QObject pointer converter class instantiation:
    * @example examples/cpp/types/meta.cc:2
    *
+   * A registered handler takes precedence over the built-in
+   * conversion of the same meta type. Conversions do not lock the
+   * handlers table: handlers must be registered and unregistered
+   * while no @ref State is converting values, typically before any
+   * @ref State is created.
+   *
    * @see qRegisterMetaType @see #QTLUA_METATYPE
    * @see #QTLUA_METATYPE_ID @see #QTLUA_METATYPE_QOBJECT
    */
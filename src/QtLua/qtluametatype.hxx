@@ -32,8 +32,6 @@ namespace QtLua {
       if ((_type = QMetaType::type(name)))
 	{
 	  _typename = 0;
-	  if (types_map.contains(_type))
-	    throw String("Lua conversion handler already registered for type %").arg(_type);
 	}
       else
 	{
@@ -41,7 +39,7 @@ namespace QtLua {
 	  _type = qRegisterMetaType<X>(name);
 	}
 
-      types_map.insert(_type, reinterpret_cast<metatype_void_t*>(this));
+      metatype_register(_type, reinterpret_cast<metatype_void_t*>(this));
     }
 
   template <typename X>
@@ -50,16 +48,13 @@ namespace QtLua {
       _type = type;
       _typename = 0;
 
-      if (types_map.contains(type))
-	throw String("Lua conversion handler already registered for type %").arg(type);
-
-      types_map.insert(type, reinterpret_cast<metatype_void_t*>(this));
+      metatype_register(type, reinterpret_cast<metatype_void_t*>(this));
     }
 
   template <typename X>
   MetaType<X>::~MetaType()
     {
-      types_map.remove(_type);
+      metatype_unregister(_type);
       if (_typename)
 	QMetaType::unregisterType(_typename);
     }
@@ -0,0 +1,177 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUANUMERICBUFFER_HH_
+#define QTLUANUMERICBUFFER_HH_
+
+#include <QPointer>
+#include <QVector>
+
+#include "qtluauserdata.hh"
+#include "qtluaproxymethod.hh"
+#include "qtluaiterator.hh"
+
+namespace QtLua {
+
+  /**
+   * @short Typed numeric memory buffer for lua script
+   * @header QtLua/NumericBuffer
+   * @module {Container proxies}
+   *
+   * This template class exposes a numeric C array to lua script
+   * without copying it. Elements can be accessed one by one like
+   * with the @ref ArrayProxy class, but bulk operations are also
+   * available as lua methods. These are executed on the whole
+   * buffer or on a range of elements by C++ code:
+   *
+   * @list
+   *   @item @tt{buf:sum([i, j])} returns the sum of elements,
+   *   @item @tt{buf:min([i, j])} and @tt{buf:max([i, j])} return the smallest and largest elements,
+   *   @item @tt{buf:scale(f, [i, j])} multiplies elements by @tt f,
+   *   @item @tt{buf:add(x, [i, j])} adds a number or the elements of an other buffer of same type,
+   *   @item @tt{buf:dot(b, [i, j])} returns the dot product with an other buffer of same type,
+   *   @item @tt{buf:map(f, [i, j])} replaces each element by the result of the @tt f lua function,
+   *   @item @tt{buf:slice(i, j, [step])} returns a new buffer which shares memory with @tt buf.
+   * @end list
+   *
+   * Ranges are inclusive and first entry has index 1. Default range
+   * is the whole buffer. Elements of a buffer are not required to
+   * be contiguous in memory, a stride can be specified between
+   * two consecutive elements. Loops on contiguous buffers are
+   * written so that the compiler can vectorize them.
+   *
+   * A buffer may own its memory or be attached to an existing
+   * array. In the later case, the array must stay valid as long as
+   * the buffer and slices of the buffer are used. Slices keep a
+   * reference to the parent buffer so that owned memory is not
+   * released while still in use.
+   *
+   * Lua operator @tt # returns the buffer size. Lua operator @tt -
+   * returns a lua table copy of the buffer.
+   *
+   * This template is expected to be used with arithmetic types like
+   * @tt double, @tt float, @tt qint32 or @tt quint8. Values are
+   * converted to and from lua numbers using C++ conversion rules.
+   */
+
+template <class T>
+class NumericBuffer : public UserData
+{
+public:
+  QTLUA_REFTYPE(NumericBuffer);
+
+  /** Create a @ref NumericBuffer object which owns @tt size zero
+      initialized elements */
+  NumericBuffer(unsigned int size);
+  /** Create a @ref NumericBuffer object attached to an existing
+      array. No copy is performed. */
+  NumericBuffer(T *data, unsigned int size, unsigned int stride = 1);
+
+  /** Attach an other array. Memory owned by the buffer is kept
+      until the buffer is destroyed. */
+  void set_container(T *data, unsigned int size, unsigned int stride = 1);
+
+  /** Keep a reference to the object which holds the attached
+      array so that it is not destroyed while the buffer is used. */
+  void set_owner(const Ref<UserData> &owner);
+
+  /** Get pointer to first element */
+  inline T * data() const;
+  /** Get number of elements */
+  inline unsigned int size() const;
+  /** Get distance between two consecutive elements */
+  inline unsigned int stride() const;
+  /** Get reference to element at given index, first element has index 0 */
+  inline T & at(unsigned int i) const;
+
+  /** Create a buffer sharing memory with this buffer. Range is
+      given with 0 based inclusive indexes. */
+  ptr slice(unsigned int first, unsigned int last, unsigned int step = 1);
+
+  Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
+  Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
+  bool meta_contains(State &ls, const Value &key);
+  void meta_newindex(State &ls, const Value &key, const Value &value);
+  Ref<Iterator> new_iterator(State &ls);
+  bool support(Value::Operation c) const;
+
+private:
+
+  String get_type_name() const;
+
+  Value::List method_add(State &ls, const Value::List &args);
+  Value::List method_dot(State &ls, const Value::List &args);
+  Value::List method_map(State &ls, const Value::List &args);
+  Value::List method_max(State &ls, const Value::List &args);
+  Value::List method_min(State &ls, const Value::List &args);
+  Value::List method_scale(State &ls, const Value::List &args);
+  Value::List method_slice(State &ls, const Value::List &args);
+  Value::List method_sum(State &ls, const Value::List &args);
+
+  static const typename ProxyMethod<NumericBuffer>::Entry _methods[];
+
+  /**
+   * @short NumericBuffer iterator class
+   * @internal
+   */
+  class ProxyIterator : public Iterator
+  {
+  public:
+    QTLUA_REFTYPE(ProxyIterator);
+    ProxyIterator(State *ls, const Ref<NumericBuffer> &buffer);
+
+  private:
+    bool more() const;
+    void next();
+    Value get_key() const;
+    Value get_value() const;
+    ValueRef get_value_ref();
+
+    QPointer<State> _ls;
+    typename NumericBuffer::ptr _buffer;
+    unsigned int _it;
+  };
+
+  void get_range(const Value::List &args, int n, unsigned int &first, unsigned int &count) const;
+
+  static double kernel_sum(const T *p, unsigned int count, unsigned int stride);
+  static double kernel_dot(const T *p, const T *q, unsigned int count,
+			   unsigned int pstride, unsigned int qstride);
+  static void kernel_scale(T *p, unsigned int count, unsigned int stride, double f);
+  static void kernel_add(T *p, unsigned int count, unsigned int stride, double x);
+  static void kernel_add(T *p, const T *q, unsigned int count,
+			 unsigned int pstride, unsigned int qstride);
+  template <class Compare>
+  static T kernel_select(const T *p, unsigned int count, unsigned int stride);
+
+  T *_data;
+  unsigned int _size;
+  unsigned int _stride;
+  QVector<T> _storage;
+  Ref<UserData> _owner;
+};
+
+}
+
+#endif
+
@@ -0,0 +1,537 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUANUMERICBUFFER_HXX_
+#define QTLUANUMERICBUFFER_HXX_
+
+#include "qtluauserdata.hxx"
+#include "qtluaproxymethod.hxx"
+#include "qtluaiterator.hxx"
+
+namespace QtLua {
+
+  template <class T>
+  NumericBuffer<T>::NumericBuffer(unsigned int size)
+    : _storage(size)
+  {
+    _data = _storage.data();
+    _size = size;
+    _stride = 1;
+  }
+
+  template <class T>
+  NumericBuffer<T>::NumericBuffer(T *data, unsigned int size, unsigned int stride)
+    : _data(data),
+      _size(size),
+      _stride(stride)
+  {
+  }
+
+  template <class T>
+  void NumericBuffer<T>::set_container(T *data, unsigned int size, unsigned int stride)
+  {
+    _data = data;
+    _size = size;
+    _stride = stride;
+  }
+
+  template <class T>
+  void NumericBuffer<T>::set_owner(const Ref<UserData> &owner)
+  {
+    _owner = owner;
+  }
+
+  template <class T>
+  T * NumericBuffer<T>::data() const
+  {
+    return _data;
+  }
+
+  template <class T>
+  unsigned int NumericBuffer<T>::size() const
+  {
+    return _data ? _size : 0;
+  }
+
+  template <class T>
+  unsigned int NumericBuffer<T>::stride() const
+  {
+    return _stride;
+  }
+
+  template <class T>
+  T & NumericBuffer<T>::at(unsigned int i) const
+  {
+    return _data[i * _stride];
+  }
+
+  template <class T>
+  typename NumericBuffer<T>::ptr NumericBuffer<T>::slice(unsigned int first, unsigned int last,
+							 unsigned int step)
+  {
+    if (!_data)
+      throw String("Can not slice null buffer.");
+
+    if (first > last || last >= _size || !step)
+      throw String("Bad buffer slice range.");
+
+    ptr s = QTLUA_REFNEW(NumericBuffer, _data + first * _stride,
+			 (last - first) / step + 1, _stride * step);
+
+    // keep the buffer which owns the memory alive
+    s->_owner = _owner.valid() ? _owner : Ref<UserData>(*this);
+
+    return s;
+  }
+
+  ////////////////////////////////////////////////// kernels
+
+  // Contiguous loops are kept simple and use independent
+  // accumulators so that they can be vectorized by the compiler.
+
+  template <class T>
+  double NumericBuffer<T>::kernel_sum(const T *p, unsigned int count, unsigned int stride)
+  {
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    unsigned int i = 0;
+
+    if (stride == 1)
+      {
+	for (; i + 4 <= count; i += 4)
+	  {
+	    s0 += p[i];
+	    s1 += p[i + 1];
+	    s2 += p[i + 2];
+	    s3 += p[i + 3];
+	  }
+      }
+
+    for (; i < count; i++)
+      s0 += p[i * stride];
+
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  template <class T>
+  double NumericBuffer<T>::kernel_dot(const T *p, const T *q, unsigned int count,
+				      unsigned int pstride, unsigned int qstride)
+  {
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    unsigned int i = 0;
+
+    if (pstride == 1 && qstride == 1)
+      {
+	for (; i + 4 <= count; i += 4)
+	  {
+	    s0 += (double)p[i] * q[i];
+	    s1 += (double)p[i + 1] * q[i + 1];
+	    s2 += (double)p[i + 2] * q[i + 2];
+	    s3 += (double)p[i + 3] * q[i + 3];
+	  }
+      }
+
+    for (; i < count; i++)
+      s0 += (double)p[i * pstride] * q[i * qstride];
+
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  template <class T>
+  void NumericBuffer<T>::kernel_scale(T *p, unsigned int count, unsigned int stride, double f)
+  {
+    if (stride == 1)
+      for (unsigned int i = 0; i < count; i++)
+	p[i] = (T)(p[i] * f);
+    else
+      for (unsigned int i = 0; i < count; i++)
+	p[i * stride] = (T)(p[i * stride] * f);
+  }
+
+  template <class T>
+  void NumericBuffer<T>::kernel_add(T *p, unsigned int count, unsigned int stride, double x)
+  {
+    if (stride == 1)
+      for (unsigned int i = 0; i < count; i++)
+	p[i] = (T)(p[i] + x);
+    else
+      for (unsigned int i = 0; i < count; i++)
+	p[i * stride] = (T)(p[i * stride] + x);
+  }
+
+  template <class T>
+  void NumericBuffer<T>::kernel_add(T *p, const T *q, unsigned int count,
+				    unsigned int pstride, unsigned int qstride)
+  {
+    if (pstride == 1 && qstride == 1)
+      for (unsigned int i = 0; i < count; i++)
+	p[i] += q[i];
+    else
+      for (unsigned int i = 0; i < count; i++)
+	p[i * pstride] += q[i * qstride];
+  }
+
+  template <class T>
+  template <class Compare>
+  T NumericBuffer<T>::kernel_select(const T *p, unsigned int count, unsigned int stride)
+  {
+    T r = p[0];
+
+    if (stride == 1)
+      for (unsigned int i = 1; i < count; i++)
+	r = Compare::select(r, p[i]);
+    else
+      for (unsigned int i = 1; i < count; i++)
+	r = Compare::select(r, p[i * stride]);
+
+    return r;
+  }
+
+  /** @internal */
+  struct NumericBufferMin
+  {
+    template <class T>
+    static inline T select(T a, T b)
+    {
+      return b < a ? b : a;
+    }
+  };
+
+  /** @internal */
+  struct NumericBufferMax
+  {
+    template <class T>
+    static inline T select(T a, T b)
+    {
+      return a < b ? b : a;
+    }
+  };
+
+  ////////////////////////////////////////////////// lua methods
+
+  template <class T>
+  void NumericBuffer<T>::get_range(const Value::List &args, int n,
+				   unsigned int &first, unsigned int &count) const
+  {
+    if (!_data)
+      throw String("Can not operate on null buffer.");
+
+    int i = Function::get_arg<int>(args, n, 1);
+    int j = Function::get_arg<int>(args, n + 1, _size);
+
+    if (i < 1 || j > (int)_size)
+      throw String("Buffer range [%, %] is out of bounds.").arg(i).arg(j);
+
+    first = i - 1;
+    count = j >= i ? j - i + 1 : 0;
+  }
+
+  template <class T>
+  const typename ProxyMethod<NumericBuffer<T> >::Entry NumericBuffer<T>::_methods[] = {
+    { "add", &NumericBuffer::method_add },
+    { "dot", &NumericBuffer::method_dot },
+    { "map", &NumericBuffer::method_map },
+    { "max", &NumericBuffer::method_max },
+    { "min", &NumericBuffer::method_min },
+    { "scale", &NumericBuffer::method_scale },
+    { "slice", &NumericBuffer::method_slice },
+    { "sum", &NumericBuffer::method_sum },
+    { 0, 0 }
+  };
+
+  template <class T>
+  Value::List NumericBuffer<T>::method_sum(State &ls, const Value::List &args)
+  {
+    unsigned int first, count;
+    get_range(args, 1, first, count);
+
+    return Value(ls, kernel_sum(&at(first), count, _stride));
+  }
+
+  template <class T>
+  Value::List NumericBuffer<T>::method_min(State &ls, const Value::List &args)
+  {
+    unsigned int first, count;
+    get_range(args, 1, first, count);
+
+    if (!count)
+      return Value(ls);
+
+    return Value(ls, (double)kernel_select<NumericBufferMin>(&at(first), count, _stride));
+  }
+
+  template <class T>
+  Value::List NumericBuffer<T>::method_max(State &ls, const Value::List &args)
+  {
+    unsigned int first, count;
+    get_range(args, 1, first, count);
+
+    if (!count)
+      return Value(ls);
+
+    return Value(ls, (double)kernel_select<NumericBufferMax>(&at(first), count, _stride));
+  }
+
+  template <class T>
+  Value::List NumericBuffer<T>::method_scale(State &ls, const Value::List &args)
+  {
+    unsigned int first, count;
+    get_range(args, 2, first, count);
+
+    kernel_scale(&at(first), count, _stride, Function::get_arg<double>(args, 1));
+    return Value::List();
+  }
+
+  template <class T>
+  Value::List NumericBuffer<T>::method_add(State &ls, const Value::List &args)
+  {
+    unsigned int first, count;
+    get_range(args, 2, first, count);
+
+    const Value &x = Function::get_arg<const Value &>(args, 1);
+
+    if (x.type() == Value::TNumber)
+      {
+	kernel_add(&at(first), count, _stride, x.to_number());
+      }
+    else
+      {
+	ptr o = x.to_userdata_cast<NumericBuffer>();
+	if (o->size() < count)
+	  throw String("Buffer operand has not enough elements.");
+	kernel_add(&at(first), o->_data, count, _stride, o->_stride);
+      }
+
+    return Value::List();
+  }
+
+  template <class T>
+  Value::List NumericBuffer<T>::method_dot(State &ls, const Value::List &args)
+  {
+    unsigned int first, count;
+    get_range(args, 2, first, count);
+
+    ptr o = Function::get_arg_ud<NumericBuffer>(args, 1);
+    if (o->size() < count)
+      throw String("Buffer operand has not enough elements.");
+
+    return Value(ls, kernel_dot(&at(first), o->_data, count, _stride, o->_stride));
+  }
+
+  template <class T>
+  Value::List NumericBuffer<T>::method_map(State &ls, const Value::List &args)
+  {
+    unsigned int first, count;
+    get_range(args, 2, first, count);
+
+    const Value &f = Function::get_arg<const Value &>(args, 1);
+
+    for (unsigned int i = first; i < first + count; i++)
+      {
+	Value::List r = f(Value(ls, (double)at(i)), Value(ls, (double)i + 1));
+	at(i) = (T)(r.isEmpty() ? 0. : r[0].to_number());
+      }
+
+    return Value::List();
+  }
+
+  template <class T>
+  Value::List NumericBuffer<T>::method_slice(State &ls, const Value::List &args)
+  {
+    int i = Function::get_arg<int>(args, 1);
+    int j = Function::get_arg<int>(args, 2, _size);
+    int step = Function::get_arg<int>(args, 3, 1);
+
+    if (i < 1 || step < 1)
+      throw String("Bad buffer slice range.");
+
+    return Value(ls, slice(i - 1, j - 1, step));
+  }
+
+  ////////////////////////////////////////////////// userdata
+
+  template <class T>
+  Value NumericBuffer<T>::meta_index(State &ls, const Value &key)
+  {
+    if (key.type() == Value::TString)
+      {
+	// methods do not depend on buffer, share them in metatable
+	Value m(ProxyMethod<NumericBuffer>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  meta_index_cache(ls, key, m);
+	return m;
+      }
+
+    if (!_data)
+      return Value(ls);
+
+    unsigned int index = (unsigned int)key.to_number() - 1;
+
+    if (index < _size)
+      return Value(ls, (double)at(index));
+    else
+      return Value(ls);
+  }
+
+  template <class T>
+  bool NumericBuffer<T>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() == Value::TString)
+      {
+	value = meta_index(ls, key);
+	return !value.is_nil();
+      }
+
+    double n;
+
+    if (!_data || !key.try_to_number(n))
+      return false;
+
+    unsigned int index = (unsigned int)n - 1;
+
+    if (index >= _size)
+      return false;
+
+    value = Value(ls, (double)at(index));
+    return true;
+  }
+
+  template <class T>
+  bool NumericBuffer<T>::meta_contains(State &ls, const Value &key)
+  {
+    double n;
+
+    if (!_data || !key.try_to_number(n))
+      return false;
+
+    unsigned int index = (unsigned int)n - 1;
+
+    return index < _size;
+  }
+
+  template <class T>
+  void NumericBuffer<T>::meta_newindex(State &ls, const Value &key, const Value &value)
+  {
+    if (!_data)
+      throw String("Can not write to null buffer.");
+
+    unsigned int index = (unsigned int)key.to_number() - 1;
+
+    if (index >= _size)
+      throw String("Buffer index is out of bounds.");
+
+    at(index) = (T)value.to_number();
+  }
+
+  template <class T>
+  Value NumericBuffer<T>::meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, size());
+      case Value::OpUnm: {
+	if (!_data)
+	  return Value(ls);
+
+	Value t(ls, Value::TTable);
+	for (unsigned int i = 0; i < _size; i++)
+	  t[i + 1] = (double)at(i);
+	return t;
+      }
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  template <class T>
+  bool NumericBuffer<T>::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpNewindex:
+      case Value::OpIterate:
+      case Value::OpLen:
+      case Value::OpUnm:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <class T>
+  String NumericBuffer<T>::get_type_name() const
+  {
+    return type_name<T>() + "[" + String::number(size()) + "]";
+  }
+
+  template <class T>
+  Ref<Iterator> NumericBuffer<T>::new_iterator(State &ls)
+  {
+    if (!_data)
+      throw String("Can not iterate on null buffer.");
+
+    return QTLUA_REFNEW(ProxyIterator, &ls, *this);
+  }
+
+  template <class T>
+  NumericBuffer<T>::ProxyIterator::ProxyIterator(State *ls, const Ref<NumericBuffer> &buffer)
+    : _ls(ls),
+      _buffer(buffer),
+      _it(0)
+  {
+  }
+
+  template <class T>
+  bool NumericBuffer<T>::ProxyIterator::more() const
+  {
+    return _buffer->_data && _it < _buffer->_size;
+  }
+
+  template <class T>
+  void NumericBuffer<T>::ProxyIterator::next()
+  {
+    _it++;
+  }
+
+  template <class T>
+  Value NumericBuffer<T>::ProxyIterator::get_key() const
+  {
+    return Value(_ls, (int)_it + 1);
+  }
+
+  template <class T>
+  Value NumericBuffer<T>::ProxyIterator::get_value() const
+  {
+    return Value(_ls, (double)_buffer->at(_it));
+  }
+
+  template <class T>
+  ValueRef NumericBuffer<T>::ProxyIterator::get_value_ref()
+  {
+    return ValueRef(Value(_ls, _buffer), Value(_ls, (double)_it + 1));
+  }
+
+}
+
+#endif
+
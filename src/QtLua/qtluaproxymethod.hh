@@ -0,0 +1,145 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUAPROXYMETHOD_HH_
+#define QTLUAPROXYMETHOD_HH_
+
+#include <QVector>
+
+#include "qtluafunction.hh"
+#include "qtluabind.hh"
+
+namespace QtLua {
+
+  /**
+   * @short Container proxies lua methods helpers
+   * @header QtLua/ProxyMethod
+   * @module {Container proxies}
+   * @internal
+   *
+   * This class contains range and bulk access functions shared by
+   * the @ref ArrayProxy, @ref QVectorProxy and @ref QListProxy
+   * lua methods. Elements are accessed with the @tt [] operator of
+   * the @tt Access type which may be a Qt container or a pointer.
+   *
+   * Lua ranges are inclusive, first entry has index 1 and are
+   * clamped to the container size. Other arguments are checked.
+   */
+  class ProxyMethodBase : public Function
+  {
+  public:
+    /** Get @tt{[first, last]} 0 based range from optional lua
+	arguments at index @tt n and @tt{n + 1}. @return entry count */
+    static inline int get_range(const Value::List &args, int n, int size,
+				int &first, int &last);
+
+    /** Implement @tt{proxy:slice(i, j)}, build a lua table from a
+	range. Entries are pushed directly on the lua stack. */
+    template <class Access>
+    static Value slice(State &ls, const Access &c, int size, const Value::List &args);
+
+    /** Push a container entry on lua stack, numbers do not go
+	through a @ref Value object. */
+    template <class X>
+    static inline void push_entry(State &ls, lua_State *st, const X &x);
+
+    /** Implement @tt{proxy:fill(v, i, j)}, assign a value to all
+	entries in range */
+    template <class Access>
+    static void fill(Access &c, int size, const Value::List &args);
+
+    /** Convert lua table entries of @tt{proxy:assign(i, table)}
+	before the container is modified, so that a conversion error
+	leaves it untouched. @return 0 based first index */
+    template <class X>
+    static int assign_values(const Value::List &args, QVector<X> &values);
+
+    /** Implement @tt{proxy:assign(i, table)}, copy converted entries
+	starting at given 0 based index. Container must have already
+	been resized if needed. */
+    template <class Access, class X>
+    static void assign(Access &c, int size, int first, const QVector<X> &values);
+
+    /** Ensure @ref QVector capacity is at least @tt size. Capacity is
+	doubled when growing so that repeated appends have amortized
+	constant cost. */
+    template <class Container>
+    static void grow(Container &c, int size);
+
+    /** Get 0 based insertion index for @tt{proxy:insert(i, ...)}
+	and @tt{proxy:remove(i, n)}, check it is not above @tt size. */
+    static inline int get_index(const Value::List &args, int size);
+
+  private:
+    String get_description() const;
+  };
+
+  /**
+   * @short Container proxies lua method class
+   * @header QtLua/ProxyMethod
+   * @module {Container proxies}
+   * @internal
+   *
+   * This class template is used to expose a member function of a
+   * container proxy as a lua method. Methods are described by a
+   * table of @ref Entry terminated by a null name. The object is
+   * expected as first argument, as done by the lua
+   * @tt{obj:method()} call syntax.
+   */
+  template <class Proxy>
+  class ProxyMethod : public ProxyMethodBase
+  {
+  public:
+    QTLUA_REFTYPE(ProxyMethod);
+
+    /** Proxy member function type */
+    typedef Value::List (Proxy::*method_t)(State &ls, const Value::List &args);
+
+    /** Methods table entry */
+    struct Entry
+    {
+      const char *_name;
+      method_t _method;
+    };
+
+    ProxyMethod(const Entry &entry);
+
+    /** Create a method object for entry named after @tt key in
+	table. @return a nil value if not found. */
+    static Value get(State &ls, const Entry *table, const Value &key);
+
+    /** Get method object for entry named after @tt key in table. The
+	object is created on first use and kept in @tt cache, which
+	is indexed like the table. @return a nil value if not found. */
+    static Value get(State &ls, const Entry *table, const Value &key,
+		     QVector<ptr> &cache);
+
+  private:
+    Value::List meta_call(State &ls, const Value::List &args);
+
+    const Entry &_entry;
+  };
+
+}
+
+#endif
+
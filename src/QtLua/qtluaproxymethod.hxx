@@ -0,0 +1,211 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUAPROXYMETHOD_HXX_
+#define QTLUAPROXYMETHOD_HXX_
+
+#include <cstring>
+
+#include "qtluafunction.hxx"
+#include "qtluabind.hxx"
+
+namespace QtLua {
+
+  inline int ProxyMethodBase::get_range(const Value::List &args, int n, int size,
+					int &first, int &last)
+  {
+    first = get_arg<int>(args, n, 1) - 1;
+    last = get_arg<int>(args, n + 1, size) - 1;
+
+    if (first < 0)
+      first = 0;
+    if (last >= size)
+      last = size - 1;
+
+    return last >= first ? last - first + 1 : 0;
+  }
+
+  template <class Access>
+  Value ProxyMethodBase::slice(State &ls, const Access &c, int size, const Value::List &args)
+  {
+    int first, last;
+    int count = get_range(args, 1, size, first, last);
+
+    lua_State *st = BindBase::stack(ls);
+
+    BindBase::new_table(st, count);
+
+    try {
+      for (int i = 0; i < count; i++)
+	{
+	  push_entry(ls, st, c[first + i]);
+	  BindBase::raw_seti(st, i + 1);
+	}
+    } catch (...) {
+      BindBase::pop_value(ls);
+      throw;
+    }
+
+    return BindBase::pop_value(ls);
+  }
+
+  template <class X>
+  void ProxyMethodBase::push_entry(State &ls, lua_State *st, const X &x)
+  {
+    BindBase::push_value(st, Value(ls, x));
+  }
+
+#define QTLUA_PROXY_PUSH_NUMBER(type)					\
+  template <>								\
+  inline void ProxyMethodBase::push_entry<type>(State &ls, lua_State *st, const type &x) \
+  {									\
+    BindBase::push_number(st, (double)x);				\
+  }
+
+  QTLUA_PROXY_PUSH_NUMBER(short)
+  QTLUA_PROXY_PUSH_NUMBER(unsigned short)
+  QTLUA_PROXY_PUSH_NUMBER(int)
+  QTLUA_PROXY_PUSH_NUMBER(unsigned int)
+  QTLUA_PROXY_PUSH_NUMBER(long)
+  QTLUA_PROXY_PUSH_NUMBER(unsigned long)
+  QTLUA_PROXY_PUSH_NUMBER(float)
+  QTLUA_PROXY_PUSH_NUMBER(double)
+
+#undef QTLUA_PROXY_PUSH_NUMBER
+
+  template <class Access>
+  void ProxyMethodBase::fill(Access &c, int size, const Value::List &args)
+  {
+    const Value &v = get_arg<const Value &>(args, 1);
+    int first, last;
+    int count = get_range(args, 2, size, first, last);
+
+    for (int i = 0; i < count; i++)
+      c[first + i] = v;
+  }
+
+  template <class X>
+  int ProxyMethodBase::assign_values(const Value::List &args, QVector<X> &values)
+  {
+    int first = get_arg<int>(args, 1) - 1;
+    const Value &t = get_arg<const Value &>(args, 2);
+    int count = t.len();
+
+    if (first < 0)
+      throw String("Container index is out of bounds.");
+
+    values.resize(count);
+
+    for (int i = 0; i < count; i++)
+      values[i] = t.raw_get(i + 1);
+
+    return first;
+  }
+
+  template <class Container>
+  void ProxyMethodBase::grow(Container &c, int size)
+  {
+    if (size > c.capacity())
+      c.reserve(qMax(size, c.capacity() * 2));
+  }
+
+  inline int ProxyMethodBase::get_index(const Value::List &args, int size)
+  {
+    int i = get_arg<int>(args, 1) - 1;
+
+    if (i < 0 || i > size)
+      throw String("Container index is out of bounds.");
+
+    return i;
+  }
+
+  template <class Access, class X>
+  void ProxyMethodBase::assign(Access &c, int size, int first, const QVector<X> &values)
+  {
+    int count = values.size();
+
+    if (first < 0 || first + count > size)
+      throw String("Container index is out of bounds.");
+
+    for (int i = 0; i < count; i++)
+      c[first + i] = values[i];
+  }
+
+  inline String ProxyMethodBase::get_description() const
+  {
+    return "Container proxy method";
+  }
+
+  template <class Proxy>
+  ProxyMethod<Proxy>::ProxyMethod(const Entry &entry)
+    : _entry(entry)
+  {
+  }
+
+  template <class Proxy>
+  Value ProxyMethod<Proxy>::get(State &ls, const Entry *table, const Value &key)
+  {
+    const char *name = key.to_cstring();
+
+    for (const Entry *e = table; e->_name; e++)
+      if (!strcmp(e->_name, name))
+	return Value(ls, QTLUA_REFNEW(ProxyMethod, *e));
+
+    return Value(ls);
+  }
+
+  template <class Proxy>
+  Value ProxyMethod<Proxy>::get(State &ls, const Entry *table, const Value &key,
+				QVector<ptr> &cache)
+  {
+    const char *name = key.to_cstring();
+
+    for (int i = 0; table[i]._name; i++)
+      if (!strcmp(table[i]._name, name))
+	{
+	  if (cache.size() <= i)
+	    cache.resize(i + 1);
+
+	  if (!cache[i].valid())
+	    cache[i] = QTLUA_REFNEW(ProxyMethod, table[i]);
+
+	  return Value(ls, cache[i]);
+	}
+
+    return Value(ls);
+  }
+
+  template <class Proxy>
+  Value::List ProxyMethod<Proxy>::meta_call(State &ls, const Value::List &args)
+  {
+    if (args.size() < 1)
+      throw String("Can't call method without container proxy. (use ':' instead of '.')");
+
+    Ref<Proxy> p = get_arg_ud<Proxy>(args, 0);
+
+    return (p.ptr()->*_entry._method)(ls, args);
+  }
+
+}
+
+#endif
+
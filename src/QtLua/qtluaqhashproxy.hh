@@ -68,7 +68,17 @@ public:
   /** Attach or detach container. argument may be NULL */
   void set_container(Container *hash);
 
+  /** Mark attached container as modified. Must be called when
+      entries have been inserted or removed from C++ code while lua
+      may be iterating over the container. */
+  void touch();
+
+  /** Enable or disable snapshot iteration. When enabled, new
+      iterators hold a shallow copy of the container. */
+  void set_snapshot_iteration(bool snapshot);
+
   Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
   bool meta_contains(State &ls, const Value &key);
   Ref<Iterator> new_iterator(State &ls);
   Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
@@ -78,6 +88,7 @@ private:
   void completion_patch(String &path, String &entry, int &offset);
   String get_type_name() const;
 
+protected:
   /**
    * @short QHashProxyRo iterator class
    * @internal
@@ -88,6 +99,15 @@ private:
     QTLUA_REFTYPE(ProxyIterator);
     ProxyIterator(State *ls, const Ref<QHashProxyRo> &proxy);
 
+    /** Get iterated container, may be a snapshot copy. */
+    const Container & container() const;
+    /** Restrict iteration to a range of the iterated container. */
+    void set_range(const typename Container::const_iterator &begin,
+		   const typename Container::const_iterator &end);
+
+    Ref<Iterator> new_iterator(State &ls);
+    bool support(Value::Operation c) const;
+
   private:
     bool more() const;
     void next();
@@ -97,12 +117,38 @@ private:
 
     QPointer<State> _ls;
     typename QHashProxyRo::ptr _proxy;
-    typename Container::iterator _it;
+    bool _snapshot_mode;
+    mutable Container _snapshot;
+    typename Container::const_iterator _it;
+    typename Container::const_iterator _end;
+    typename Container::const_iterator _cend;
+    unsigned int _version;
+    int _size;
   };
 
-protected:
+  /** @internal Insert, replace or remove (@tt nil value) an entry. */
+  void set_entry(const Value &key, const Value &value);
+
+  /** @internal Lookup entry, a key which can not be converted to
+      the container key type is reported as a miss. */
+  bool find_entry(const Value &key, typename Container::const_iterator &i) const;
+
+  /** @internal Convert lua value to key type without throwing. */
+  template <class K>
+  static bool try_key(const Value &v, K &k);
+  static inline bool try_key(const Value &v, String &k);
+  static inline bool try_key(const Value &v, QString &k);
+  static inline bool try_key(const Value &v, double &k);
+  static inline bool try_key(const Value &v, int &k);
+  static inline bool try_key(const Value &v, unsigned int &k);
+
   /** @internal */
   Container *_hash;
+  /** @internal Incremented on insertion and removal of entries. */
+  unsigned int _version;
+
+private:
+  bool _snapshot_iteration;
 };
 
   /**
@@ -126,6 +172,22 @@ protected:
    * Lua operator @tt # returns the container entry count. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Iterators walk the live container by default. Values of existing
+   * entries may be changed during iteration, but an error is raised
+   * when the iteration continues after entries have been inserted or
+   * removed. Entry count, container data sharing and a version stamp
+   * are checked on each step. The version stamp is updated by the
+   * proxy on insertion and removal and by the @ref
+   * QHashProxyRo::touch function.
+   *
+   * In snapshot mode, enabled by @ref
+   * QHashProxyRo::set_snapshot_iteration, an iterator holds a shallow
+   * copy of the container instead. Qt implicit sharing makes this
+   * copy constant time; data is only duplicated if the container is
+   * modified while the iteration is in progress. The iteration then
+   * keeps going over the entries present when it started. The copy is
+   * released when the iteration ends.
+   *
    * The following example show how a @ref QMap object indexed with
    * @ref String objects can be accessed from both C++ and lua script
    * directly:
@@ -137,6 +199,7 @@ template <class Container>
 class QHashProxy : public QHashProxyRo<Container>
 {
   using QHashProxyRo<Container>::_hash;
+  using QHashProxyRo<Container>::_version;
 
 public:
   QTLUA_REFTYPE(QHashProxy);
@@ -147,7 +210,7 @@ public:
   QHashProxy(Container &hash);
 
   void meta_newindex(State &ls, const Value &key, const Value &value);
-  bool support(enum Value::Operation c);
+  bool support(enum Value::Operation c) const;
 };
 
 }
@@ -28,13 +28,17 @@ namespace QtLua {
 
   template <class Container>
   QHashProxyRo<Container>::QHashProxyRo()
-    : _hash(0)
+    : _snapshot_iteration(false),
+      _hash(0),
+      _version(0)
   {
   }
 
   template <class Container>
   QHashProxyRo<Container>::QHashProxyRo(Container &hash)
-    : _hash(&hash)
+    : _snapshot_iteration(false),
+      _hash(&hash),
+      _version(0)
   {
   }
 
@@ -54,6 +58,19 @@ namespace QtLua {
   void QHashProxyRo<Container>::set_container(Container *hash)
   {
     _hash = hash;
+    _version++;
+  }
+
+  template <class Container>
+  void QHashProxyRo<Container>::touch()
+  {
+    _version++;
+  }
+
+  template <class Container>
+  void QHashProxyRo<Container>::set_snapshot_iteration(bool snapshot)
+  {
+    _snapshot_iteration = snapshot;
   }
 
   template <class Container>
@@ -62,18 +79,113 @@ namespace QtLua {
     if (!_hash)
       return Value(ls);
 
-    typename Container::iterator i = _hash->find(key);
+    typename Container::const_iterator i = _hash->constFind(key);
 
-    if (i == _hash->end())
+    if (i == _hash->constEnd())
       return Value(ls);
     else
       return Value(ls, i.value());
   }
 
+  template <class Container>
+  template <class K>
+  bool QHashProxyRo<Container>::try_key(const Value &v, K &k)
+  {
+    try {
+      const K &c = v;
+      k = c;
+      return true;
+    } catch (const String &) {
+      return false;
+    }
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::try_key(const Value &v, String &k)
+  {
+    switch (v.type())
+      {
+      case Value::TString:
+      case Value::TNumber:
+	k = v.to_string();
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::try_key(const Value &v, QString &k)
+  {
+    String s;
+
+    if (!try_key(v, s))
+      return false;
+
+    k = s.to_qstring();
+    return true;
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::try_key(const Value &v, double &k)
+  {
+    return v.try_to_number(k);
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::try_key(const Value &v, int &k)
+  {
+    double n;
+
+    if (!v.try_to_number(n))
+      return false;
+
+    k = (int)n;
+    return true;
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::try_key(const Value &v, unsigned int &k)
+  {
+    double n;
+
+    if (!v.try_to_number(n))
+      return false;
+
+    k = (unsigned int)n;
+    return true;
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::find_entry(const Value &key, typename Container::const_iterator &i) const
+  {
+    typename Container::key_type k;
+
+    if (!_hash || !try_key(key, k))
+      return false;
+
+    i = _hash->constFind(k);
+    return i != _hash->constEnd();
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    typename Container::const_iterator i;
+
+    if (!find_entry(key, i))
+      return false;
+
+    value = Value(ls, i.value());
+    return true;
+  }
+
   template <class Container>
   bool QHashProxyRo<Container>::meta_contains(State &ls, const Value &key)
   {
-    return _hash->contains(key);
+    typename Container::const_iterator i;
+
+    return find_entry(key, i);
   }
 
   template <class Container>
@@ -106,7 +218,7 @@ namespace QtLua {
   }
 
   template <class Container>
-  bool QHashProxy<Container>::support(enum Value::Operation c)
+  bool QHashProxy<Container>::support(enum Value::Operation c) const
   {
     switch (c)
       {
@@ -123,14 +235,26 @@ namespace QtLua {
 
   template <class Container>
   void QHashProxy<Container>::meta_newindex(State &ls, const Value &key, const Value &value)
+  {
+    this->set_entry(key, value);
+  }
+
+  template <class Container>
+  void QHashProxyRo<Container>::set_entry(const Value &key, const Value &value)
   {
     if (!_hash)
       throw String("Can not write to null container.");
 
-    else if (value.type() == Value::TNil)
+    int size = _hash->size();
+
+    if (value.type() == Value::TNil)
       _hash->remove(key);
     else
       _hash->insert(key, value);
+
+    // changing the value of an existing entry keeps iterators valid
+    if (_hash->size() != size)
+      _version++;
   }
 
   template <class Container>
@@ -146,14 +270,70 @@ namespace QtLua {
   QHashProxyRo<Container>::ProxyIterator::ProxyIterator(State *ls, const Ref<QHashProxyRo> &proxy)
     : _ls(ls),
       _proxy(proxy),
-      _it(_proxy->_hash->begin())
+      _snapshot_mode(proxy->_snapshot_iteration),
+      _version(proxy->_version),
+      _size(proxy->_hash->size())
   {
+    if (_snapshot_mode)
+      {
+	// implicitly shared, no entry is copied here
+	_snapshot = *_proxy->_hash;
+	_it = _snapshot.constBegin();
+	_end = _snapshot.constEnd();
+      }
+    else
+      {
+	_it = _proxy->_hash->constBegin();
+	_end = _proxy->_hash->constEnd();
+      }
+
+    _cend = container().constEnd();
+  }
+
+  template <class Container>
+  const Container & QHashProxyRo<Container>::ProxyIterator::container() const
+  {
+    return _snapshot_mode ? _snapshot : *_proxy->_hash;
+  }
+
+  template <class Container>
+  void QHashProxyRo<Container>::ProxyIterator::set_range(const typename Container::const_iterator &begin,
+							 const typename Container::const_iterator &end)
+  {
+    _it = begin;
+    _end = end;
+  }
+
+  template <class Container>
+  Ref<Iterator> QHashProxyRo<Container>::ProxyIterator::new_iterator(State &ls)
+  {
+    return *this;
+  }
+
+  template <class Container>
+  bool QHashProxyRo<Container>::ProxyIterator::support(Value::Operation c) const
+  {
+    return c == Value::OpIterate;
   }
 
   template <class Container>
   bool QHashProxyRo<Container>::ProxyIterator::more() const
   {
-    return _proxy->_hash && _it != _proxy->_hash->end();
+    if (_snapshot_mode)
+      {
+	if (_it != _end)
+	  return true;
+
+	// release shared data so that later writes do not copy
+	_snapshot = Container();
+	return false;
+      }
+
+    if (!_proxy->_hash || _proxy->_version != _version ||
+	_proxy->_hash->size() != _size || _proxy->_hash->constEnd() != _cend)
+      throw String("Container has been modified during iteration.");
+
+    return _it != _end;
   }
 
   template <class Container>
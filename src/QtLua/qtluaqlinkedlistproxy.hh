@@ -29,34 +29,40 @@
 namespace QtLua {
 
   /**
-   * @short QLinkedList access wrapper for lua script
+   * @short QLinkedList read only access wrapper for lua script
    * @header QtLua/QLinkedListProxy
    * @module {Container proxies}
    *
-   * This template class may be used to iterate over an attached @ref QLinkedList
-   * container object from lua script.
+   * This template class may be used to expose an attached @ref
+   * QLinkedList container object to lua script for read access. The
+   * @ref QLinkedListProxy class may be used for read/write access.
    *
-   * Containers may be attached and detached from the wrapper object
-   * to solve cases where we want to destroy the container when lua
-   * still holds references to the wrapper object. When no container
-   * is attached access will raise an error.
+   * See @ref QLinkedListProxy class documentation for details.
    */
 
 template <class Container>
-class QLinkedListProxy : public UserData
+class QLinkedListProxyRo : public UserData
 {
 public:
-  QTLUA_REFTYPE(QLinkedListProxy);
+  QTLUA_REFTYPE(QLinkedListProxyRo);
 
-  /** Create a @ref QListProxy object with no attached container */
-  QLinkedListProxy();
-  /** Create a @ref QListProxy object and attach given container */
-  QLinkedListProxy(Container &list);
+  /** Create a @ref QLinkedListProxy object with no attached container */
+  QLinkedListProxyRo();
+  /** Create a @ref QLinkedListProxy object and attach given container */
+  QLinkedListProxyRo(Container &list);
 
   /** Attach or detach container. argument may be NULL */
   void set_container(Container *list);
 
+  /** Drop cached positions. Must be called when entries have been
+      inserted or removed from C++ code. */
+  void invalidate();
+
+  Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
+  bool meta_contains(State &ls, const Value &key);
   Ref<Iterator> new_iterator(State &ls);
+  Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
   bool support(Value::Operation c) const;
 
 private:
@@ -64,14 +70,14 @@ private:
   String get_type_name() const;
 
   /**
-   * @short QLinkedListProxy iterator class
+   * @short QLinkedListProxyRo iterator class
    * @internal
    */
   class ProxyIterator : public Iterator
   {
   public:
     QTLUA_REFTYPE(ProxyIterator);
-    ProxyIterator(State *ls, const Ref<QLinkedListProxy> &proxy);
+    ProxyIterator(State *ls, const Ref<QLinkedListProxyRo> &proxy);
 
   private:
     bool more() const;
@@ -81,12 +87,100 @@ private:
     ValueRef get_value_ref();
 
     QPointer<State> _ls;
-    typename QLinkedListProxy::ptr _proxy;
+    typename QLinkedListProxyRo::ptr _proxy;
     typename Container::const_iterator _it;
     unsigned int _i;
   };
 
+  /** @internal Cached list position. List size and end iterator
+      are recorded to detect most changes made from C++ code. */
+  template <class It>
+  struct Cursor
+  {
+    Cursor() : _index(-1), _size(0) {}
+
+    It _it;
+    It _end;
+    int _index;
+    int _size;
+  };
+
+  /** Move cursor to 0 based index, starting from the cached
+      position, the head or the tail, whichever is nearest. */
+  template <class It>
+  static It seek_cursor(Cursor<It> &c, int index, It begin, It end, int size);
+
+protected:
+  /** Get iterator to entry at 0 based index. */
+  typename Container::const_iterator seek(int index);
+
+  /** Get mutable iterator to entry at 0 based index for write
+      access. The list is detached if its data is shared. */
+  typename Container::iterator seek_write(int index);
+
+  /** Update cached positions after an entry has been removed or
+      inserted by the proxy. */
+  void cursor_update(const typename Container::iterator &it, int index);
+
   Container *_linkedlist;
+
+private:
+  Cursor<typename Container::const_iterator> _cursor;
+  Cursor<typename Container::iterator> _wcursor;
+};
+
+  /**
+   * @short QLinkedList access wrapper for lua script
+   * @header QtLua/QLinkedListProxy
+   * @module {Container proxies}
+   *
+   * This template class may be used to expose an attached @ref
+   * QLinkedList container object to lua script for read and write
+   * access. The @ref QLinkedListProxyRo class may be used for read
+   * only access.
+   *
+   * Containers may be attached and detached from the wrapper object
+   * to solve cases where we want to destroy the container when lua
+   * still holds references to the wrapper object. When no container
+   * is attached access will raise an error.
+   *
+   * First entry has index 1. Lua @tt nil value is returned if no such
+   * entry exists on table read. A @tt nil value write will delete
+   * entry at given index. Write access at list size + 1 append a new
+   * entry to the list.
+   *
+   * Lua operator @tt # returns the container entry count. Lua
+   * operator @tt - returns a lua table copy of the container.
+   *
+   * The proxy remembers the last accessed position so that
+   * sequential and nearby accesses do not walk the list from its
+   * head. The cached position is dropped when the list size or data
+   * pointer has changed, but removing and inserting the same number
+   * of entries from C++ code can not be detected. The @ref
+   * QLinkedListProxyRo::invalidate function must be called after
+   * entries have been inserted or removed from C++ code.
+   *
+   * The following example show how a @ref QLinkedList object can be
+   * accessed from both C++ and lua script directly:
+   *
+   * @example examples/cpp/proxy/qlinkedlistproxy_string.cc:1
+   */
+
+template <class Container>
+class QLinkedListProxy : public QLinkedListProxyRo<Container>
+{
+  using QLinkedListProxyRo<Container>::_linkedlist;
+
+public:
+  QTLUA_REFTYPE(QLinkedListProxy);
+
+  /** Create a @ref QLinkedListProxy object */
+  QLinkedListProxy();
+  /** Create a @ref QLinkedListProxy object */
+  QLinkedListProxy(Container &list);
+
+  void meta_newindex(State &ls, const Value &key, const Value &value);
+  bool support(enum Value::Operation c) const;
 };
 
 }
@@ -27,38 +27,200 @@
 namespace QtLua {
 
   template <class Container>
-  QLinkedListProxy<Container>::QLinkedListProxy()
+  QLinkedListProxyRo<Container>::QLinkedListProxyRo()
     : _linkedlist(0)
   {
   }
 
   template <class Container>
-  QLinkedListProxy<Container>::QLinkedListProxy(Container &list)
+  QLinkedListProxyRo<Container>::QLinkedListProxyRo(Container &list)
     : _linkedlist(&list)
   {
   }
 
   template <class Container>
-  void QLinkedListProxy<Container>::set_container(Container *list)
+  QLinkedListProxy<Container>::QLinkedListProxy()
+    : QLinkedListProxyRo<Container>()
+  {
+  }
+
+  template <class Container>
+  QLinkedListProxy<Container>::QLinkedListProxy(Container &list)
+    : QLinkedListProxyRo<Container>(list)
+  {
+  }
+
+  template <class Container>
+  void QLinkedListProxyRo<Container>::set_container(Container *list)
   {
     _linkedlist = list;
+    invalidate();
   }
 
   template <class Container>
-  Ref<Iterator> QLinkedListProxy<Container>::new_iterator(State &ls)
+  void QLinkedListProxyRo<Container>::invalidate()
+  {
+    _cursor._index = -1;
+    _wcursor._index = -1;
+  }
+
+  template <class Container>
+  template <class It>
+  It QLinkedListProxyRo<Container>::seek_cursor(Cursor<It> &c, int index, It begin, It end, int size)
+  {
+    // list has been detached or resized from C++ code
+    if (c._index < 0 || c._size != size || c._end != end)
+      {
+	c._it = begin;
+	c._index = 0;
+	c._size = size;
+	c._end = end;
+      }
+
+    int dist = qAbs(index - c._index);
+
+    if (index < dist)
+      {
+	c._it = begin;
+	c._index = 0;
+      }
+    else if (size - index < dist)
+      {
+	c._it = end;
+	c._index = size;
+      }
+
+    while (c._index < index)
+      {
+	++c._it;
+	++c._index;
+      }
+
+    while (c._index > index)
+      {
+	--c._it;
+	--c._index;
+      }
+
+    return c._it;
+  }
+
+  template <class Container>
+  typename Container::const_iterator QLinkedListProxyRo<Container>::seek(int index)
+  {
+    const Container &list = *_linkedlist;
+
+    return seek_cursor(_cursor, index, list.constBegin(), list.constEnd(), list.size());
+  }
+
+  template <class Container>
+  typename Container::iterator QLinkedListProxyRo<Container>::seek_write(int index)
+  {
+    Container &list = *_linkedlist;
+    // detach first so that the end iterator identifies list data
+    typename Container::iterator begin = list.begin();
+
+    return seek_cursor(_wcursor, index, begin, list.end(), list.size());
+  }
+
+  template <class Container>
+  void QLinkedListProxyRo<Container>::cursor_update(const typename Container::iterator &it, int index)
+  {
+    Container &list = *_linkedlist;
+    int size = list.size();
+
+    _wcursor._it = it;
+    _wcursor._end = list.end();
+    _wcursor._index = index;
+    _wcursor._size = size;
+
+    _cursor._it = it;
+    _cursor._end = list.constEnd();
+    _cursor._index = index;
+    _cursor._size = size;
+  }
+
+  template <class Container>
+  Value QLinkedListProxyRo<Container>::meta_index(State &ls, const Value &key)
   {
     if (!_linkedlist)
-      throw String("Can not iterate on null container.");
+      return Value(ls);
 
-    return QTLUA_REFNEW(ProxyIterator, &ls, *this);
+    int index = (unsigned int)key.to_number() - 1;
+
+    if (index >= 0 && index < _linkedlist->size())
+      return Value(ls, *seek(index));
+    else
+      return Value(ls);
+  }
+
+  template <class Container>
+  bool QLinkedListProxyRo<Container>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    double n;
+
+    if (!_linkedlist || !key.try_to_number(n))
+      return false;
+
+    int index = (unsigned int)n - 1;
+
+    if (index < 0 || index >= _linkedlist->size())
+      return false;
+
+    value = Value(ls, *seek(index));
+    return true;
   }
 
   template <class Container>
-  bool QLinkedListProxy<Container>::support(Value::Operation c) const
+  bool QLinkedListProxyRo<Container>::meta_contains(State &ls, const Value &key)
+  {
+    double n;
+
+    if (!_linkedlist || !key.try_to_number(n))
+      return false;
+
+    int index = (unsigned int)n - 1;
+
+    return index >= 0 && index < _linkedlist->size();
+  }
+
+  template <class Container>
+  Value QLinkedListProxyRo<Container>::meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	// QLinkedList keeps its entry count up to date
+	return Value(ls, _linkedlist ? _linkedlist->size() : 0);
+
+      case Value::OpUnm: {
+	if (!_linkedlist)
+	  return Value(ls);
+
+	Value t(Value::new_table(ls, _linkedlist->size()));
+	int i = 1;
+
+	for (typename Container::const_iterator it = _linkedlist->constBegin();
+	     it != _linkedlist->constEnd(); ++it)
+	  t.raw_set(i++, Value(ls, *it));
+
+	return t;
+      }
+
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  template <class Container>
+  bool QLinkedListProxyRo<Container>::support(Value::Operation c) const
   {
     switch (c)
       {
+      case Value::OpIndex:
       case Value::OpIterate:
+      case Value::OpLen:
+      case Value::OpUnm:
 	return true;
       default:
 	return false;
@@ -66,47 +228,111 @@ namespace QtLua {
   }
 
   template <class Container>
-  String QLinkedListProxy<Container>::get_type_name() const
+  bool QLinkedListProxy<Container>::support(enum Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpNewindex:
+      case Value::OpIterate:
+      case Value::OpLen:
+      case Value::OpUnm:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <class Container>
+  String QLinkedListProxyRo<Container>::get_type_name() const
   {
     return type_name<Container>();
   }
 
   template <class Container>
-  QLinkedListProxy<Container>::ProxyIterator::ProxyIterator(State *ls, const Ref<QLinkedListProxy> &proxy)
+  void QLinkedListProxy<Container>::meta_newindex(State &ls, const Value &key, const Value &value)
+  {
+    if (!_linkedlist)
+      throw String("Can not write to null container.");
+
+    unsigned int index = (unsigned int)key.to_number() - 1;
+    unsigned int size = _linkedlist->size();
+
+    if (index > size)
+      throw String("QLinkedList index is out of bounds.");
+
+    if (value.type() == Value::TNil)
+      {
+	if (index < size)
+	  {
+	    typename Container::iterator it = _linkedlist->erase(this->seek_write(index));
+	    this->cursor_update(it, index);
+	  }
+      }
+    else
+      {
+	typename Container::value_type v = value;
+
+	if (index == size)
+	  {
+	    _linkedlist->append(v);
+	    typename Container::iterator it = _linkedlist->end();
+	    this->cursor_update(--it, index);
+	  }
+	else
+	  {
+	    typename Container::iterator it = this->seek_write(index);
+	    *it = v;
+	    this->cursor_update(it, index);
+	  }
+      }
+  }
+
+  template <class Container>
+  Ref<Iterator> QLinkedListProxyRo<Container>::new_iterator(State &ls)
+  {
+    if (!_linkedlist)
+      throw String("Can not iterate on null container.");
+
+    return QTLUA_REFNEW(ProxyIterator, &ls, *this);
+  }
+
+  template <class Container>
+  QLinkedListProxyRo<Container>::ProxyIterator::ProxyIterator(State *ls, const Ref<QLinkedListProxyRo> &proxy)
     : _ls(ls),
       _proxy(proxy),
-      _it(_proxy->_linkedlist->begin()),
-      _i(0)
+      _it(_proxy->_linkedlist->constBegin()),
+      _i(1)
   {
   }
 
   template <class Container>
-  bool QLinkedListProxy<Container>::ProxyIterator::more() const
+  bool QLinkedListProxyRo<Container>::ProxyIterator::more() const
   {
-    return _proxy->_linkedlist && _it != _proxy->_linkedlist->end();
+    return _proxy->_linkedlist && _it != _proxy->_linkedlist->constEnd();
   }
 
   template <class Container>
-  void QLinkedListProxy<Container>::ProxyIterator::next()
+  void QLinkedListProxyRo<Container>::ProxyIterator::next()
   {
     _it++;
     _i++;
   }
 
   template <class Container>
-  Value QLinkedListProxy<Container>::ProxyIterator::get_key() const
+  Value QLinkedListProxyRo<Container>::ProxyIterator::get_key() const
   {
     return Value(_ls, (int)_i);
   }
 
   template <class Container>
-  Value QLinkedListProxy<Container>::ProxyIterator::get_value() const
+  Value QLinkedListProxyRo<Container>::ProxyIterator::get_value() const
   {
     return Value(_ls, *_it);
   }
 
   template <class Container>
-  ValueRef QLinkedListProxy<Container>::ProxyIterator::get_value_ref()
+  ValueRef QLinkedListProxyRo<Container>::ProxyIterator::get_value_ref()
   {
     return ValueRef(Value(_ls, _proxy), Value(_ls, (double)_i));
   }
@@ -25,6 +25,7 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluaproxymethod.hh"
 
 namespace QtLua {
 
@@ -37,6 +38,9 @@ namespace QtLua {
    * container object to lua script for read access. The @ref
    * QListProxy class may be used for read/write access.
    *
+   * The @tt{proxy:slice(i, j)} lua method returns a lua table with
+   * entries in the inclusive range.
+   *
    * See @ref QListProxy class documentation for details and examples.
    */
 
@@ -55,6 +59,7 @@ public:
   void set_container(Container *list);
 
   Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
   bool meta_contains(State &ls, const Value &key);
   Ref<Iterator> new_iterator(State &ls);
   Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
@@ -87,7 +92,11 @@ private:
     unsigned int _i;
   };
 
+  static const typename ProxyMethod<QListProxyRo>::Entry _methods[];
+
 protected:
+  Value::List method_slice(State &ls, const Value::List &args);
+
   Container *_list;
 };
 
@@ -113,6 +122,23 @@ protected:
    * Lua operator @tt # returns the container entry count. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Ranges of entries can be accessed in a single call with the
+   * following lua methods:
+   * @list
+   *   @item @tt{proxy:slice(i, j)} returns a lua table with entries in range,
+   *   @item @tt{proxy:assign(i, table)} copies table entries starting at index @tt i, the list is extended if needed,
+   *   @item @tt{proxy:fill(v, i, j)} sets all entries in range to @tt v,
+   *   @item @tt{proxy:push(v, ...)} appends values and returns the new entry count,
+   *   @item @tt{proxy:insert(i, v, ...)} inserts values before index @tt i,
+   *   @item @tt{proxy:remove(i, [n])} removes @tt n entries starting at index @tt i,
+   *   @item @tt{proxy:reserve(n)} preallocates storage for @tt n entries,
+   *   @item @tt{proxy:clear()} removes all entries.
+   * @end list
+   * Ranges are inclusive and default to the whole container. Entries
+   * are moved once for a multiple values insertion or removal.
+   * String keys are only used to look up methods: reading an
+   * unknown name gives @tt nil instead of an index conversion error.
+   *
    * The following example show how a @ref QList object can be
    * accessed from both C++ and lua script directly:
    *
@@ -132,8 +158,21 @@ public:
   /** Create a @ref QListProxy object */
   QListProxy(Container &list);
 
+  Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
   void meta_newindex(State &ls, const Value &key, const Value &value);
-  bool support(enum Value::Operation c);
+  bool support(enum Value::Operation c) const;
+
+private:
+  Value::List method_assign(State &ls, const Value::List &args);
+  Value::List method_fill(State &ls, const Value::List &args);
+  Value::List method_push(State &ls, const Value::List &args);
+  Value::List method_insert(State &ls, const Value::List &args);
+  Value::List method_remove(State &ls, const Value::List &args);
+  Value::List method_reserve(State &ls, const Value::List &args);
+  Value::List method_clear(State &ls, const Value::List &args);
+
+  static const typename ProxyMethod<QListProxy>::Entry _methods[];
 };
 
 }
@@ -23,6 +23,7 @@
 
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluaproxymethod.hxx"
 
 namespace QtLua {
 
@@ -56,9 +57,38 @@ namespace QtLua {
     _list = list;
   }
 
+  template <class Container>
+  const typename ProxyMethod<QListProxyRo<Container> >::Entry
+  QListProxyRo<Container>::_methods[] = {
+    { "slice", &QListProxyRo::method_slice },
+    { 0, 0 }
+  };
+
+  template <class Container>
+  const typename ProxyMethod<QListProxy<Container> >::Entry
+  QListProxy<Container>::_methods[] = {
+    { "assign", &QListProxy::method_assign },
+    { "clear", &QListProxy::method_clear },
+    { "fill", &QListProxy::method_fill },
+    { "insert", &QListProxy::method_insert },
+    { "push", &QListProxy::method_push },
+    { "remove", &QListProxy::method_remove },
+    { "reserve", &QListProxy::method_reserve },
+    { "slice", &QListProxy::method_slice },
+    { 0, 0 }
+  };
+
   template <class Container>
   Value QListProxyRo<Container>::meta_index(State &ls, const Value &key)
   {
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<QListProxyRo>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  meta_index_cache(ls, key, m);
+	return m;
+      }
+
     if (!_list)
       return Value(ls);
 
@@ -70,16 +100,40 @@ namespace QtLua {
       return Value(ls);
   }
 
+  template <class Container>
+  bool QListProxyRo<Container>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() == Value::TString)
+      {
+	value = meta_index(ls, key);
+	return !value.is_nil();
+      }
+
+    double n;
+
+    if (!_list || !key.try_to_number(n))
+      return false;
+
+    int index = (unsigned int)n - 1;
+
+    if (index < 0 || index >= _list->size())
+      return false;
+
+    value = Value(ls, _list->at(index));
+    return true;
+  }
+
   template <class Container>
   bool QListProxyRo<Container>::meta_contains(State &ls, const Value &key)
   {
-    try {
-      int index = (unsigned int)key.to_number() - 1;
+    double n;
 
-      return index >= 0 && index < _list->size();
-    } catch (String &e) {
+    if (!_list || !key.try_to_number(n))
       return false;
-    }
+
+    int index = (unsigned int)n - 1;
+
+    return index >= 0 && index < _list->size();
   }
 
   template <class Container>
@@ -112,7 +166,7 @@ namespace QtLua {
   }
 
   template <class Container>
-  bool QListProxy<Container>::support(enum Value::Operation c)
+  bool QListProxy<Container>::support(enum Value::Operation c) const
   {
     switch (c)
       {
@@ -133,6 +187,153 @@ namespace QtLua {
     return type_name<Container>();
   }
 
+  template <class Container>
+  Value QListProxy<Container>::meta_index(State &ls, const Value &key)
+  {
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<QListProxy>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  this->meta_index_cache(ls, key, m);
+	return m;
+      }
+
+    return QListProxyRo<Container>::meta_index(ls, key);
+  }
+
+  template <class Container>
+  bool QListProxy<Container>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() == Value::TString)
+      {
+	value = meta_index(ls, key);
+	return !value.is_nil();
+      }
+
+    return QListProxyRo<Container>::meta_find(ls, key, value);
+  }
+
+  template <class Container>
+  Value::List QListProxyRo<Container>::method_slice(State &ls, const Value::List &args)
+  {
+    if (!_list)
+      throw String("Can not read from null container.");
+
+    return ProxyMethodBase::slice(ls, *_list, _list->size(), args);
+  }
+
+  template <class Container>
+  Value::List QListProxy<Container>::method_fill(State &ls, const Value::List &args)
+  {
+    if (!_list)
+      throw String("Can not write to null container.");
+
+    ProxyMethodBase::fill(*_list, _list->size(), args);
+    return Value::List();
+  }
+
+  template <class Container>
+  Value::List QListProxy<Container>::method_assign(State &ls, const Value::List &args)
+  {
+    if (!_list)
+      throw String("Can not write to null container.");
+
+    QVector<typename Container::value_type> values;
+    int first = ProxyMethodBase::assign_values(args, values);
+    int size = first + values.size();
+
+    if (first > _list->size())
+      throw String("QList index is out of bounds.");
+
+    while (_list->size() < size)
+      _list->append(typename Container::value_type());
+
+    ProxyMethodBase::assign(*_list, _list->size(), first, values);
+    return Value::List();
+  }
+
+  template <class Container>
+  Value::List QListProxy<Container>::method_push(State &ls, const Value::List &args)
+  {
+    if (!_list)
+      throw String("Can not write to null container.");
+
+    // QList append has amortized constant cost
+    for (int i = 1; i < args.size(); i++)
+      {
+	typename Container::value_type v = args[i];
+	_list->append(v);
+      }
+
+    return Value(ls, _list->size());
+  }
+
+  template <class Container>
+  Value::List QListProxy<Container>::method_insert(State &ls, const Value::List &args)
+  {
+    if (!_list)
+      throw String("Can not write to null container.");
+
+    int first = ProxyMethodBase::get_index(args, _list->size());
+    int n = args.size() - 2;
+
+    if (n == 1)
+      {
+	_list->insert(first, args[2]);
+      }
+    else if (n > 1)
+      {
+	// rebuild list to move trailing entries once
+	Container l;
+	l.reserve(_list->size() + n);
+	l += _list->mid(0, first);
+	for (int i = 0; i < n; i++)
+	  {
+	    typename Container::value_type v = args[i + 2];
+	    l.append(v);
+	  }
+	l += _list->mid(first);
+	*_list = l;
+      }
+
+    return Value::List();
+  }
+
+  template <class Container>
+  Value::List QListProxy<Container>::method_remove(State &ls, const Value::List &args)
+  {
+    if (!_list)
+      throw String("Can not write to null container.");
+
+    int first = ProxyMethodBase::get_index(args, _list->size());
+    int n = qMin(Function::get_arg<int>(args, 2, 1), _list->size() - first);
+
+    if (n > 0)
+      _list->erase(_list->begin() + first, _list->begin() + first + n);
+
+    return Value::List();
+  }
+
+  template <class Container>
+  Value::List QListProxy<Container>::method_reserve(State &ls, const Value::List &args)
+  {
+    if (!_list)
+      throw String("Can not write to null container.");
+
+    _list->reserve(Function::get_arg<int>(args, 1));
+    return Value::List();
+  }
+
+  template <class Container>
+  Value::List QListProxy<Container>::method_clear(State &ls, const Value::List &args)
+  {
+    if (!_list)
+      throw String("Can not write to null container.");
+
+    _list->clear();
+    return Value::List();
+  }
+
   template <class Container>
   void QListProxy<Container>::meta_newindex(State &ls, const Value &key, const Value &value)
   {
@@ -171,7 +372,7 @@ namespace QtLua {
   QListProxyRo<Container>::ProxyIterator::ProxyIterator(State *ls, const Ref<QListProxyRo> &proxy)
     : _ls(ls),
       _proxy(proxy),
-      _it(_proxy->_list->begin()),
+      _it(_proxy->_list->constBegin()),
       _i(1)
   {
   }
@@ -179,7 +380,7 @@ namespace QtLua {
   template <class Container>
   bool QListProxyRo<Container>::ProxyIterator::more() const
   {
-    return _proxy->_list && _it != _proxy->_list->end();
+    return _proxy->_list && _it != _proxy->_list->constEnd();
   }
 
   template <class Container>
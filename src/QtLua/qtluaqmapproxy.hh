@@ -0,0 +1,125 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUAQMAPPROXY_HH_
+#define QTLUAQMAPPROXY_HH_
+
+#include "qtluaqhashproxy.hh"
+#include "qtluaproxymethod.hh"
+
+namespace QtLua {
+
+  /**
+   * @short QMap read only access wrapper with ordered queries
+   * @header QtLua/QMapProxy
+   * @module {Container proxies}
+   *
+   * This template class extends the @ref QHashProxyRo class with
+   * ordered queries on an attached @ref QMap container. The @ref
+   * QMapProxy class may be used for read/write access.
+   *
+   * See @ref QMapProxy class documentation for details.
+   */
+
+template <class Container>
+class QMapProxyRo : public QHashProxyRo<Container>
+{
+  using QHashProxyRo<Container>::_hash;
+
+  typedef typename QHashProxyRo<Container>::ProxyIterator iterator_t;
+  typedef typename Container::key_type key_t;
+
+public:
+  QTLUA_REFTYPE(QMapProxyRo);
+
+  /** Create a @ref QMapProxy object with no attached container */
+  QMapProxyRo();
+  /** Create a @ref QMapProxy object and attach given container */
+  QMapProxyRo(Container &map);
+
+  Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
+
+private:
+  Value::List method_range(State &ls, const Value::List &args);
+  Value::List method_from(State &ls, const Value::List &args);
+  Value::List method_first(State &ls, const Value::List &args);
+  Value::List method_last(State &ls, const Value::List &args);
+
+  Value::List new_range(State &ls, bool bounded, const key_t &lo, const key_t &hi);
+
+  static const typename ProxyMethod<QMapProxyRo>::Entry _methods[];
+  QVector<typename ProxyMethod<QMapProxyRo>::ptr> _method_cache;
+};
+
+  /**
+   * @short QMap access wrapper with ordered queries
+   * @header QtLua/QMapProxy
+   * @module {Container proxies}
+   *
+   * This template class may be used to expose an attached @ref QMap
+   * container object to lua script for read and write access, as
+   * done by the @ref QHashProxy class. It also provides the following
+   * lua methods which rely on map ordering:
+   * @list
+   *   @item @tt{proxy:range(lo, hi)} returns an iterator over entries with keys in the inclusive range,
+   *   @item @tt{proxy:from(key)} returns an iterator over entries with keys not less than @tt key,
+   *   @item @tt{proxy:first()} returns key and value of the first entry,
+   *   @item @tt{proxy:last()} returns key and value of the last entry.
+   * @end list
+   *
+   * Range bounds are found using @tt{QMap::lowerBound} and
+   * @tt{QMap::upperBound}; entries are not copied. Returned
+   * iterators may be used with the lua @tt{each()} function:
+   * @tt{for k, v in each(proxy:range(lo, hi)) do ... end}. They follow
+   * the modification checks and snapshot mode of the @ref
+   * QHashProxyRo iterators.
+   *
+   * Entries of a map with string keys take precedence over methods
+   * with the same name on table read: a map entry with the @tt
+   * "range" key hides the @tt range method, which can not be called
+   * with the @tt{proxy:range()} syntax in this case. Method objects
+   * are created on first use and kept by the proxy.
+   */
+
+template <class Container>
+class QMapProxy : public QMapProxyRo<Container>
+{
+  using QMapProxyRo<Container>::_hash;
+  using QMapProxyRo<Container>::_version;
+
+public:
+  QTLUA_REFTYPE(QMapProxy);
+
+  /** Create a @ref QMapProxy object */
+  QMapProxy();
+  /** Create a @ref QMapProxy object */
+  QMapProxy(Container &map);
+
+  void meta_newindex(State &ls, const Value &key, const Value &value);
+  bool support(enum Value::Operation c) const;
+};
+
+}
+
+#endif
+
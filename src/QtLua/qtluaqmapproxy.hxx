@@ -0,0 +1,186 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUAQMAPPROXY_HXX_
+#define QTLUAQMAPPROXY_HXX_
+
+#include "qtluaqhashproxy.hxx"
+#include "qtluaproxymethod.hxx"
+
+namespace QtLua {
+
+  template <class Container>
+  QMapProxyRo<Container>::QMapProxyRo()
+    : QHashProxyRo<Container>()
+  {
+  }
+
+  template <class Container>
+  QMapProxyRo<Container>::QMapProxyRo(Container &map)
+    : QHashProxyRo<Container>(map)
+  {
+  }
+
+  template <class Container>
+  QMapProxy<Container>::QMapProxy()
+    : QMapProxyRo<Container>()
+  {
+  }
+
+  template <class Container>
+  QMapProxy<Container>::QMapProxy(Container &map)
+    : QMapProxyRo<Container>(map)
+  {
+  }
+
+  template <class Container>
+  const typename ProxyMethod<QMapProxyRo<Container> >::Entry
+  QMapProxyRo<Container>::_methods[] = {
+    { "first", &QMapProxyRo::method_first },
+    { "from", &QMapProxyRo::method_from },
+    { "last", &QMapProxyRo::method_last },
+    { "range", &QMapProxyRo::method_range },
+    { 0, 0 }
+  };
+
+  template <class Container>
+  Value QMapProxyRo<Container>::meta_index(State &ls, const Value &key)
+  {
+    if (key.type() != Value::TString)
+      return QHashProxyRo<Container>::meta_index(ls, key);
+
+    // container entries take precedence over methods with the same
+    // name, methods are not cached in the metatable for this reason
+    typename Container::const_iterator i;
+
+    if (this->find_entry(key, i))
+      return Value(ls, i.value());
+
+    Value m(ProxyMethod<QMapProxyRo>::get(ls, _methods, key, _method_cache));
+
+    if (m.is_nil())
+      return QHashProxyRo<Container>::meta_index(ls, key);
+
+    return m;
+  }
+
+  template <class Container>
+  bool QMapProxyRo<Container>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (QHashProxyRo<Container>::meta_find(ls, key, value))
+      return true;
+
+    if (key.type() != Value::TString)
+      return false;
+
+    value = ProxyMethod<QMapProxyRo>::get(ls, _methods, key, _method_cache);
+    return !value.is_nil();
+  }
+
+  template <class Container>
+  Value::List QMapProxyRo<Container>::new_range(State &ls, bool bounded, const key_t &lo, const key_t &hi)
+  {
+    if (!_hash)
+      throw String("Can not iterate on null container.");
+
+    typename iterator_t::ptr i = QTLUA_REFNEW(iterator_t, &ls, *this);
+    const Container &c = i->container();
+
+    typename Container::const_iterator first = c.lowerBound(lo);
+
+    if (!bounded)
+      i->set_range(first, c.constEnd());
+    else if (hi < lo)
+      i->set_range(first, first);   // empty range
+    else
+      i->set_range(first, c.upperBound(hi));
+
+    return Value(ls, i);
+  }
+
+  template <class Container>
+  Value::List QMapProxyRo<Container>::method_range(State &ls, const Value::List &args)
+  {
+    key_t lo = Function::get_arg<key_t>(args, 1);
+
+    if (args.size() < 3)
+      return new_range(ls, false, lo, lo);
+
+    key_t hi = Function::get_arg<key_t>(args, 2);
+    return new_range(ls, true, lo, hi);
+  }
+
+  template <class Container>
+  Value::List QMapProxyRo<Container>::method_from(State &ls, const Value::List &args)
+  {
+    key_t lo = Function::get_arg<key_t>(args, 1);
+
+    return new_range(ls, false, lo, lo);
+  }
+
+  template <class Container>
+  Value::List QMapProxyRo<Container>::method_first(State &ls, const Value::List &args)
+  {
+    if (!_hash || _hash->isEmpty())
+      return Value::List();
+
+    typename Container::const_iterator i = _hash->constBegin();
+    return Value::List(Value(ls, i.key()), Value(ls, i.value()));
+  }
+
+  template <class Container>
+  Value::List QMapProxyRo<Container>::method_last(State &ls, const Value::List &args)
+  {
+    if (!_hash || _hash->isEmpty())
+      return Value::List();
+
+    typename Container::const_iterator i = _hash->constEnd();
+    --i;
+    return Value::List(Value(ls, i.key()), Value(ls, i.value()));
+  }
+
+  template <class Container>
+  bool QMapProxy<Container>::support(enum Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpNewindex:
+      case Value::OpIterate:
+      case Value::OpLen:
+      case Value::OpUnm:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <class Container>
+  void QMapProxy<Container>::meta_newindex(State &ls, const Value &key, const Value &value)
+  {
+    this->set_entry(key, value);
+  }
+
+}
+
+#endif
+
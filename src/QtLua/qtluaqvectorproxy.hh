@@ -25,6 +25,7 @@
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
+#include "qtluaproxymethod.hh"
 
 namespace QtLua {
 
@@ -40,6 +41,9 @@ namespace QtLua {
    * QVector may be resized if accessing above current size, depending
    * on @tt resize template parameter value.
    *
+   * The @tt{proxy:slice(i, j)} lua method returns a lua table with
+   * entries in the inclusive range.
+   *
    * See @ref QVectorProxy class documentation for details and examples.
    */
 
@@ -59,6 +63,7 @@ public:
 
   Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
   Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
   bool meta_contains(State &ls, const Value &key);
   Ref<Iterator> new_iterator(State &ls);
   bool support(Value::Operation c) const;
@@ -89,7 +94,11 @@ private:
     unsigned int _it;
   };
 
+  static const typename ProxyMethod<QVectorProxyRo>::Entry _methods[];
+
 protected:
+  Value::List method_slice(State &ls, const Value::List &args);
+
   Container *_vector;
 };
 
@@ -118,6 +127,30 @@ protected:
    * Lua operator @tt # returns the container entry count. Lua
    * operator @tt - returns a lua table copy of the container.
    *
+   * Ranges of entries can be accessed in a single call with the
+   * following lua methods:
+   * @list
+   *   @item @tt{proxy:slice(i, j)} returns a lua table with entries in range,
+   *   @item @tt{proxy:assign(i, table)} copies table entries starting at index @tt i,
+   *   @item @tt{proxy:fill(v, i, j)} sets all entries in range to @tt v.
+   * @end list
+   * Ranges are inclusive and default to the whole container.
+   * String keys are only used to look up methods: reading an
+   * unknown name gives @tt nil instead of an index conversion error.
+   *
+   * When the @tt resize template argument is true, the following
+   * lua methods are also available:
+   * @list
+   *   @item @tt{proxy:push(v, ...)} appends values and returns the new entry count,
+   *   @item @tt{proxy:insert(i, v, ...)} inserts values before index @tt i,
+   *   @item @tt{proxy:remove(i, [n])} removes @tt n entries starting at index @tt i,
+   *   @item @tt{proxy:reserve(n)} preallocates storage for @tt n entries,
+   *   @item @tt{proxy:clear()} removes all entries.
+   * @end list
+   * Storage capacity is doubled when growing so that appending
+   * entries one by one has linear cost. Entries are moved once for
+   * a multiple values insertion or removal.
+   *
    * The following example show how a @ref QVector object can be
    * accessed from both C++ and lua script directly:
    *
@@ -137,8 +170,22 @@ public:
   /** Create a @ref QVectorProxy object */
   QVectorProxy(Container &vector);
 
+  Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
   void meta_newindex(State &ls, const Value &key, const Value &value);
-  bool support(enum Value::Operation c);
+  bool support(enum Value::Operation c) const;
+
+private:
+  Value::List method_assign(State &ls, const Value::List &args);
+  Value::List method_fill(State &ls, const Value::List &args);
+  Value::List method_push(State &ls, const Value::List &args);
+  Value::List method_insert(State &ls, const Value::List &args);
+  Value::List method_remove(State &ls, const Value::List &args);
+  Value::List method_reserve(State &ls, const Value::List &args);
+  Value::List method_clear(State &ls, const Value::List &args);
+
+  static const typename ProxyMethod<QVectorProxy>::Entry _methods[];
+  static const typename ProxyMethod<QVectorProxy>::Entry _resize_methods[];
 };
 
 }
@@ -23,6 +23,7 @@
 
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
+#include "qtluaproxymethod.hxx"
 
 namespace QtLua {
 
@@ -56,9 +57,47 @@ namespace QtLua {
     _vector = vector;
   }
 
+  template <class Container, bool resize>
+  const typename ProxyMethod<QVectorProxyRo<Container, resize> >::Entry
+  QVectorProxyRo<Container, resize>::_methods[] = {
+    { "slice", &QVectorProxyRo::method_slice },
+    { 0, 0 }
+  };
+
+  template <class Container, bool resize>
+  const typename ProxyMethod<QVectorProxy<Container, resize> >::Entry
+  QVectorProxy<Container, resize>::_methods[] = {
+    { "assign", &QVectorProxy::method_assign },
+    { "fill", &QVectorProxy::method_fill },
+    { "slice", &QVectorProxy::method_slice },
+    { 0, 0 }
+  };
+
+  template <class Container, bool resize>
+  const typename ProxyMethod<QVectorProxy<Container, resize> >::Entry
+  QVectorProxy<Container, resize>::_resize_methods[] = {
+    { "assign", &QVectorProxy::method_assign },
+    { "clear", &QVectorProxy::method_clear },
+    { "fill", &QVectorProxy::method_fill },
+    { "insert", &QVectorProxy::method_insert },
+    { "push", &QVectorProxy::method_push },
+    { "remove", &QVectorProxy::method_remove },
+    { "reserve", &QVectorProxy::method_reserve },
+    { "slice", &QVectorProxy::method_slice },
+    { 0, 0 }
+  };
+
   template <class Container, bool resize>
   Value QVectorProxyRo<Container, resize>::meta_index(State &ls, const Value &key)
   { 
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<QVectorProxyRo>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  meta_index_cache(ls, key, m);
+	return m;
+      }
+
     if (!_vector)
       return Value(ls);
 
@@ -70,16 +109,40 @@ namespace QtLua {
       return Value(ls);
   }
 
+  template <class Container, bool resize>
+  bool QVectorProxyRo<Container, resize>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() == Value::TString)
+      {
+	value = meta_index(ls, key);
+	return !value.is_nil();
+      }
+
+    double n;
+
+    if (!_vector || !key.try_to_number(n))
+      return false;
+
+    int index = (unsigned int)n - 1;
+
+    if (index < 0 || index >= _vector->size())
+      return false;
+
+    value = Value(ls, _vector->at(index));
+    return true;
+  }
+
   template <class Container, bool resize>
   bool QVectorProxyRo<Container, resize>::meta_contains(State &ls, const Value &key)
   {
-    try {
-      int index = (unsigned int)key.to_number() - 1;
+    double n;
 
-      return index >= 0 && index < _vector->size();
-    } catch (String &e) {
+    if (!_vector || !key.try_to_number(n))
       return false;
-    }
+
+    int index = (unsigned int)n - 1;
+
+    return index >= 0 && index < _vector->size();
   }
 
   template <class Container, bool resize>
@@ -112,7 +175,7 @@ namespace QtLua {
   }
 
   template <class Container, bool resize>
-  bool QVectorProxy<Container, resize>::support(enum Value::Operation c)
+  bool QVectorProxy<Container, resize>::support(enum Value::Operation c) const
   {
     switch (c)
       {
@@ -133,6 +196,150 @@ namespace QtLua {
     return type_name<Container>();
   }
 
+  template <class Container, bool resize>
+  Value QVectorProxy<Container, resize>::meta_index(State &ls, const Value &key)
+  { 
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<QVectorProxy>::get(ls, resize ? _resize_methods : _methods, key));
+	if (!m.is_nil())
+	  this->meta_index_cache(ls, key, m);
+	return m;
+      }
+
+    return QVectorProxyRo<Container, resize>::meta_index(ls, key);
+  }
+
+  template <class Container, bool resize>
+  bool QVectorProxy<Container, resize>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() == Value::TString)
+      {
+	value = meta_index(ls, key);
+	return !value.is_nil();
+      }
+
+    return QVectorProxyRo<Container, resize>::meta_find(ls, key, value);
+  }
+
+  template <class Container, bool resize>
+  Value::List QVectorProxyRo<Container, resize>::method_slice(State &ls, const Value::List &args)
+  {
+    if (!_vector)
+      throw String("Can not read from null container.");
+
+    return ProxyMethodBase::slice(ls, *_vector, _vector->size(), args);
+  }
+
+  template <class Container, bool resize>
+  Value::List QVectorProxy<Container, resize>::method_fill(State &ls, const Value::List &args)
+  {
+    if (!_vector)
+      throw String("Can not write to null container.");
+
+    ProxyMethodBase::fill(*_vector, _vector->size(), args);
+    return Value::List();
+  }
+
+  template <class Container, bool resize>
+  Value::List QVectorProxy<Container, resize>::method_assign(State &ls, const Value::List &args)
+  {
+    if (!_vector)
+      throw String("Can not write to null container.");
+
+    QVector<typename Container::value_type> values;
+    int first = ProxyMethodBase::assign_values(args, values);
+    int size = first + values.size();
+
+    if (resize && size > _vector->size())
+      {
+	ProxyMethodBase::grow(*_vector, size);
+	_vector->resize(size);
+      }
+
+    ProxyMethodBase::assign(*_vector, _vector->size(), first, values);
+    return Value::List();
+  }
+
+  template <class Container, bool resize>
+  Value::List QVectorProxy<Container, resize>::method_push(State &ls, const Value::List &args)
+  {
+    if (!_vector)
+      throw String("Can not write to null container.");
+
+    int n = args.size() - 1;
+    ProxyMethodBase::grow(*_vector, _vector->size() + n);
+
+    for (int i = 1; i <= n; i++)
+      _vector->append(args[i]);
+
+    return Value(ls, _vector->size());
+  }
+
+  template <class Container, bool resize>
+  Value::List QVectorProxy<Container, resize>::method_insert(State &ls, const Value::List &args)
+  {
+    if (!_vector)
+      throw String("Can not write to null container.");
+
+    int first = ProxyMethodBase::get_index(args, _vector->size());
+    int n = args.size() - 2;
+
+    if (n > 0)
+      {
+	// convert first, a conversion error leaves the vector untouched
+	QVector<typename Container::value_type> values(n);
+
+	for (int i = 0; i < n; i++)
+	  values[i] = args[i + 2];
+
+	ProxyMethodBase::grow(*_vector, _vector->size() + n);
+
+	// move trailing entries once
+	_vector->insert(first, n, typename Container::value_type());
+
+	for (int i = 0; i < n; i++)
+	  (*_vector)[first + i] = values[i];
+      }
+
+    return Value::List();
+  }
+
+  template <class Container, bool resize>
+  Value::List QVectorProxy<Container, resize>::method_remove(State &ls, const Value::List &args)
+  {
+    if (!_vector)
+      throw String("Can not write to null container.");
+
+    int first = ProxyMethodBase::get_index(args, _vector->size());
+    int n = qMin(Function::get_arg<int>(args, 2, 1), _vector->size() - first);
+
+    if (n > 0)
+      _vector->remove(first, n);
+
+    return Value::List();
+  }
+
+  template <class Container, bool resize>
+  Value::List QVectorProxy<Container, resize>::method_reserve(State &ls, const Value::List &args)
+  {
+    if (!_vector)
+      throw String("Can not write to null container.");
+
+    _vector->reserve(Function::get_arg<int>(args, 1));
+    return Value::List();
+  }
+
+  template <class Container, bool resize>
+  Value::List QVectorProxy<Container, resize>::method_clear(State &ls, const Value::List &args)
+  {
+    if (!_vector)
+      throw String("Can not write to null container.");
+
+    _vector->clear();
+    return Value::List();
+  }
+
   template <class Container, bool resize>
   void QVectorProxy<Container, resize>::meta_newindex(State &ls, const Value &key, const Value &value)
   {
@@ -154,7 +361,10 @@ namespace QtLua {
 	if (index >= _vector->size())
 	  {
 	    if (resize)
-	      _vector->resize(index + 1);
+	      {
+		ProxyMethodBase::grow(*_vector, index + 1);
+		_vector->resize(index + 1);
+	      }
 	    else
 	      throw String("QVector index is out of bounds.");
 	  }
@@ -0,0 +1,209 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUARECORDARRAYPROXY_HH_
+#define QTLUARECORDARRAYPROXY_HH_
+
+#include <cstddef>
+#include <QVector>
+
+#include "qtluauserdata.hh"
+#include "qtluaproxymethod.hh"
+
+namespace QtLua {
+
+  /** @internal @module {Container proxies}
+      Record field descriptor entry */
+  struct RecordField
+  {
+    const char *name;		//< Lua field name
+    size_t offset;		//< Field offset in record
+    Value (*get)(State &ls, const void *field); //< Pointer to field read function
+    void (*set)(void *field, const Value &value); //< Pointer to field write function
+    Ref<UserData> (*column)(const Ref<UserData> &owner, void *field,
+			    unsigned int size, unsigned int record_size); //< Pointer to column view function
+  };
+
+  /** @internal @module {Container proxies}
+      Record field access functions for a given field type */
+  template <class X>
+  struct RecordFieldType
+  {
+    static Value get(State &ls, const void *field);
+    static void set(void *field, const Value &value);
+    static Ref<UserData> column(const Ref<UserData> &owner, void *field,
+				unsigned int size, unsigned int record_size);
+  };
+
+  /** @internal @module {Container proxies} */
+  template <bool>
+  struct RecordFieldCheck;
+
+  /** @internal @module {Container proxies} */
+  template <>
+  struct RecordFieldCheck<true>
+  {
+  };
+
+  /**
+   * @short C array of records access wrapper for lua script
+   * @header QtLua/RecordArrayProxy
+   * @module {Container proxies}
+   *
+   * This template class may be used to expose a C array or a @ref
+   * QVector of plain C++ structures to lua script. Fields of the
+   * record type must be described in a table at compile time using
+   * the @ref #QTLUA_RECORD family of macros:
+   *
+   * @example examples/cpp/proxy/recordarrayproxy.cc:1
+   *
+   * Each table entry holds the field offset in the record and
+   * pointers to access functions for the field type. A compile
+   * error occurs if the declared type size does not match the
+   * field size. Field types must be arithmetic types. A name sorted
+   * index of the fields table is built on first access so that field
+   * lookup is a binary search.
+   *
+   * First record has index 1. Reading @tt{rec[i]} returns a small
+   * row object which refers to the record without copying it;
+   * @tt{rec[i].x} then reads the field through its access function.
+   * Writing @tt{rec[i].x} updates the record in place.
+   *
+   * The following lua methods do not create row objects:
+   * @list
+   *   @item @tt{rec:get(i, name)} returns the value of a field,
+   *   @item @tt{rec:set(i, name, v)} changes the value of a field,
+   *   @item @tt{rec:column(name)} returns a @ref NumericBuffer which
+   *     shares memory with the array and covers all records.
+   * @end list
+   * Column views rely on the buffer stride, so the record size must
+   * be a multiple of the field size. A view keeps a reference to
+   * the proxy but not to the array; it must not be used once the
+   * array has been detached or reallocated.
+   *
+   * When a @ref QVector is attached, its data pointer and size are
+   * read on each access so that the proxy follows changes made to
+   * the vector from C++ code.
+   *
+   * Lua operator @tt # returns the record count.
+   */
+
+template <class T>
+class RecordArrayProxy : public UserData
+{
+public:
+  QTLUA_REFTYPE(RecordArrayProxy);
+
+  /** Create a @ref RecordArrayProxy object with no attached array */
+  RecordArrayProxy();
+  /** Create a @ref RecordArrayProxy object and attach given array */
+  RecordArrayProxy(T *array, unsigned int size);
+  /** Create a @ref RecordArrayProxy object and attach given vector */
+  RecordArrayProxy(QVector<T> &vector);
+
+  /** Attach or detach array. argument may be NULL */
+  void set_container(T *array, unsigned int size);
+  /** Attach vector. argument may be NULL */
+  void set_container(QVector<T> *vector);
+
+  Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
+  bool meta_contains(State &ls, const Value &key);
+  Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
+  bool support(Value::Operation c) const;
+
+  /**
+   * This macro must appear once in the body of the record type.
+   */
+#define QTLUA_RECORD(record_name)					\
+    static const QtLua::RecordField _qtlua_record_fields[];
+
+  /**
+   * This macro must be used once at global scope to list fields of
+   * the record type.
+   */
+#define QTLUA_RECORD_FIELDS(record_name, ...)				\
+    const QtLua::RecordField record_name::_qtlua_record_fields[] = { __VA_ARGS__, { 0 } };
+
+  /**
+   * Declare a record field entry with its C++ type.
+   */
+#define QTLUA_RECORD_FIELD(record_name, member, type)			\
+    { #member, offsetof(record_name, member)				\
+      + 0 * sizeof(QtLua::RecordFieldCheck<sizeof(((record_name *)0)->member) == sizeof(type)>), \
+      &QtLua::RecordFieldType<type>::get, &QtLua::RecordFieldType<type>::set, \
+      &QtLua::RecordFieldType<type>::column }
+
+private:
+
+  String get_type_name() const;
+
+  /**
+   * @short RecordArrayProxy row class
+   * @internal
+   */
+  class Row : public UserData
+  {
+  public:
+    QTLUA_REFTYPE(Row);
+    Row(const Ref<RecordArrayProxy> &proxy, unsigned int index);
+
+  private:
+    Value meta_index(State &ls, const Value &key);
+    bool meta_find(State &ls, const Value &key, Value &value);
+    bool meta_contains(State &ls, const Value &key);
+    void meta_newindex(State &ls, const Value &key, const Value &value);
+    bool support(Value::Operation c) const;
+
+    typename RecordArrayProxy::ptr _proxy;
+    unsigned int _index;
+  };
+
+  friend class Row;
+
+  struct field_less
+  {
+    bool operator()(int a, int b) const;
+  };
+
+  static QVector<int> build_index();
+  static const RecordField * find_field(const Value &key);
+  static const RecordField & get_field(const Value &key);
+  char * get_record(unsigned int index) const;
+  inline T * get_array() const;
+  inline unsigned int get_size() const;
+
+  Value::List method_column(State &ls, const Value::List &args);
+  Value::List method_get(State &ls, const Value::List &args);
+  Value::List method_set(State &ls, const Value::List &args);
+
+  static const typename ProxyMethod<RecordArrayProxy>::Entry _methods[];
+
+  T *_array;
+  unsigned int _size;
+  QVector<T> *_vector;
+};
+
+}
+
+#endif
+
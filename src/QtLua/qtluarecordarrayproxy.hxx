@@ -0,0 +1,375 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+
+#ifndef QTLUARECORDARRAYPROXY_HXX_
+#define QTLUARECORDARRAYPROXY_HXX_
+
+#include <algorithm>
+#include <cstring>
+
+#include "qtluauserdata.hxx"
+#include "qtluaproxymethod.hxx"
+#include "qtluanumericbuffer.hxx"
+
+namespace QtLua {
+
+  template <class X>
+  Value RecordFieldType<X>::get(State &ls, const void *field)
+  {
+    return Value(ls, (double)*(const X*)field);
+  }
+
+  template <class X>
+  void RecordFieldType<X>::set(void *field, const Value &value)
+  {
+    *(X*)field = (X)value.to_number();
+  }
+
+  template <class X>
+  Ref<UserData> RecordFieldType<X>::column(const Ref<UserData> &owner, void *field,
+					   unsigned int size, unsigned int record_size)
+  {
+    if (record_size % sizeof(X))
+      throw String("Record size is not a multiple of field size, can not create column view.");
+
+    typename NumericBuffer<X>::ptr b = QTLUA_REFNEW(NumericBuffer<X>, (X*)field, size, record_size / sizeof(X));
+    b->set_owner(owner);
+
+    return b;
+  }
+
+  template <class T>
+  RecordArrayProxy<T>::RecordArrayProxy()
+    : _array(0),
+      _size(0),
+      _vector(0)
+  {
+  }
+
+  template <class T>
+  RecordArrayProxy<T>::RecordArrayProxy(T *array, unsigned int size)
+    : _array(array),
+      _size(size),
+      _vector(0)
+  {
+  }
+
+  template <class T>
+  RecordArrayProxy<T>::RecordArrayProxy(QVector<T> &vector)
+    : _array(0),
+      _size(0),
+      _vector(&vector)
+  {
+  }
+
+  template <class T>
+  void RecordArrayProxy<T>::set_container(T *array, unsigned int size)
+  {
+    _array = array;
+    _size = size;
+    _vector = 0;
+  }
+
+  template <class T>
+  void RecordArrayProxy<T>::set_container(QVector<T> *vector)
+  {
+    _array = 0;
+    _size = 0;
+    _vector = vector;
+  }
+
+  template <class T>
+  T * RecordArrayProxy<T>::get_array() const
+  {
+    // vector data may have moved since last access
+    return _vector ? _vector->data() : _array;
+  }
+
+  template <class T>
+  unsigned int RecordArrayProxy<T>::get_size() const
+  {
+    return _vector ? _vector->size() : _size;
+  }
+
+  template <class T>
+  const typename ProxyMethod<RecordArrayProxy<T> >::Entry
+  RecordArrayProxy<T>::_methods[] = {
+    { "column", &RecordArrayProxy::method_column },
+    { "get", &RecordArrayProxy::method_get },
+    { "set", &RecordArrayProxy::method_set },
+    { 0, 0 }
+  };
+
+  template <class T>
+  bool RecordArrayProxy<T>::field_less::operator()(int a, int b) const
+  {
+    return strcmp(T::_qtlua_record_fields[a].name,
+		  T::_qtlua_record_fields[b].name) < 0;
+  }
+
+  template <class T>
+  QVector<int> RecordArrayProxy<T>::build_index()
+  {
+    QVector<int> index;
+
+    for (int i = 0; T::_qtlua_record_fields[i].name; i++)
+      index.push_back(i);
+
+    std::sort(index.begin(), index.end(), field_less());
+    return index;
+  }
+
+  template <class T>
+  const RecordField * RecordArrayProxy<T>::find_field(const Value &key)
+  {
+    // fields table entries sorted by name, built on first lookup
+    static const QVector<int> index = build_index();
+
+    if (key.type() == Value::TString)
+      {
+	const char *name = key.to_cstring();
+	int l = 0, h = index.size();
+
+	while (l < h)
+	  {
+	    int m = (l + h) / 2;
+	    const RecordField &f = T::_qtlua_record_fields[index[m]];
+	    int c = strcmp(name, f.name);
+
+	    if (c == 0)
+	      return &f;
+	    if (c < 0)
+	      h = m;
+	    else
+	      l = m + 1;
+	  }
+      }
+
+    return 0;
+  }
+
+  template <class T>
+  const RecordField & RecordArrayProxy<T>::get_field(const Value &key)
+  {
+    const RecordField *f = find_field(key);
+
+    if (f)
+      return *f;
+
+    throw String("No such record field `%::%'")
+      .arg(UserData::type_name<T>()).arg(key.to_string_p(false));
+  }
+
+  template <class T>
+  char * RecordArrayProxy<T>::get_record(unsigned int index) const
+  {
+    T *array = get_array();
+
+    if (!array)
+      throw String("Can not access null array.");
+
+    if (index >= get_size())
+      throw String("Record index is out of bounds.");
+
+    return (char*)(array + index);
+  }
+
+  template <class T>
+  Value RecordArrayProxy<T>::meta_index(State &ls, const Value &key)
+  {
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<RecordArrayProxy>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  meta_index_cache(ls, key, m);
+	return m;
+      }
+
+    unsigned int index = (unsigned int)key.to_number() - 1;
+
+    if (!get_array() || index >= get_size())
+      return Value(ls);
+
+    return Value(ls, QTLUA_REFNEW(Row, *this, index));
+  }
+
+  template <class T>
+  bool RecordArrayProxy<T>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() == Value::TString)
+      {
+	value = meta_index(ls, key);
+	return !value.is_nil();
+      }
+
+    double n;
+
+    if (!get_array() || !key.try_to_number(n))
+      return false;
+
+    unsigned int index = (unsigned int)n - 1;
+
+    if (index >= get_size())
+      return false;
+
+    value = Value(ls, QTLUA_REFNEW(Row, *this, index));
+    return true;
+  }
+
+  template <class T>
+  bool RecordArrayProxy<T>::meta_contains(State &ls, const Value &key)
+  {
+    double n;
+
+    if (!get_array() || !key.try_to_number(n))
+      return false;
+
+    unsigned int index = (unsigned int)n - 1;
+
+    return index < get_size();
+  }
+
+  template <class T>
+  Value RecordArrayProxy<T>::meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, get_array() ? get_size() : 0);
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  template <class T>
+  bool RecordArrayProxy<T>::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpLen:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  template <class T>
+  String RecordArrayProxy<T>::get_type_name() const
+  {
+    return type_name<T>();
+  }
+
+  template <class T>
+  Value::List RecordArrayProxy<T>::method_column(State &ls, const Value::List &args)
+  {
+    const RecordField &f = get_field(Function::get_arg<const Value &>(args, 1));
+
+    T *array = get_array();
+
+    if (!array)
+      throw String("Can not access null array.");
+
+    // the view keeps the proxy alive
+    return Value(ls, f.column(*this, (char*)array + f.offset, get_size(), sizeof(T)));
+  }
+
+  template <class T>
+  Value::List RecordArrayProxy<T>::method_get(State &ls, const Value::List &args)
+  {
+    char *r = get_record((unsigned int)Function::get_arg<int>(args, 1) - 1);
+    const RecordField &f = get_field(Function::get_arg<const Value &>(args, 2));
+
+    return f.get(ls, r + f.offset);
+  }
+
+  template <class T>
+  Value::List RecordArrayProxy<T>::method_set(State &ls, const Value::List &args)
+  {
+    char *r = get_record((unsigned int)Function::get_arg<int>(args, 1) - 1);
+    const RecordField &f = get_field(Function::get_arg<const Value &>(args, 2));
+
+    f.set(r + f.offset, Function::get_arg<const Value &>(args, 3));
+    return Value::List();
+  }
+
+  template <class T>
+  RecordArrayProxy<T>::Row::Row(const Ref<RecordArrayProxy> &proxy, unsigned int index)
+    : _proxy(proxy),
+      _index(index)
+  {
+  }
+
+  template <class T>
+  Value RecordArrayProxy<T>::Row::meta_index(State &ls, const Value &key)
+  {
+    const RecordField &f = get_field(key);
+
+    return f.get(ls, _proxy->get_record(_index) + f.offset);
+  }
+
+  template <class T>
+  bool RecordArrayProxy<T>::Row::meta_find(State &ls, const Value &key, Value &value)
+  {
+    const RecordField *f = find_field(key);
+    const RecordArrayProxy &p = *_proxy;
+
+    T *array = p.get_array();
+
+    if (!f || !array || _index >= p.get_size())
+      return false;
+
+    value = f->get(ls, (char*)(array + _index) + f->offset);
+    return true;
+  }
+
+  template <class T>
+  bool RecordArrayProxy<T>::Row::meta_contains(State &ls, const Value &key)
+  {
+    return find_field(key) != 0;
+  }
+
+  template <class T>
+  void RecordArrayProxy<T>::Row::meta_newindex(State &ls, const Value &key, const Value &value)
+  {
+    const RecordField &f = get_field(key);
+
+    f.set(_proxy->get_record(_index) + f.offset, value);
+  }
+
+  template <class T>
+  bool RecordArrayProxy<T>::Row::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpNewindex:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+}
+
+#endif
+
@@ -43,6 +43,7 @@ namespace QtLua {
   class UserData;
   class QObjectWrapper;
   class TableIterator;
+  class SignalQueue;
 
   /** @internal */
   typedef QHash<QObject *, QObjectWrapper *> wrapper_hash_t;
@@ -90,11 +91,27 @@ class State : public QObject
   friend class UserData;
   friend class Value;
   friend class ValueRef;
+  friend class BindBase;
+  friend class Member;
   friend class TableIterator;
   friend uint qHash(const Value &lv);
 
 public:
 
+  /**
+   * Specify optional conversions used when Qt values are exposed to
+   * lua, see @ref set_conversions.
+   */
+  enum Conversion
+    {
+      ConvertDefault    = 0x0000,	//< Use plain lua tables and values
+      ConvertValueTypes = 0x0001,	//< Expose @ref QPoint, @ref QSize, @ref QRect and @ref QColor values as inline userdata
+      ConvertContainerViews = 0x0002,	//< Expose container values as read only views instead of lua tables
+      ConvertByteBuffers = 0x0004,	//< Expose @ref QByteArray values as @ref ByteBuffer objects instead of lua strings
+    };
+
+  Q_DECLARE_FLAGS(Conversions, Conversion);
+
   State();
 
   /** 
@@ -185,6 +202,31 @@ public:
    */
   void lua_do(void (*func)(lua_State *st));
 
+  /**
+   * Select optional Qt to lua conversions. When @ref
+   * ConvertValueTypes is set, geometry and color values read from
+   * @ref QObject properties and method return values are exposed as
+   * userdata objects storing the Qt value inline. Fields are
+   * accessed by name (@tt{r.x}, @tt{r.width}, @tt{c.red}) and
+   * arithmetic operators are available where Qt defines them. These
+   * objects are converted back to Qt without table parsing. Lua
+   * tables are still accepted on assignment.
+   *
+   * When @ref ConvertContainerViews is set, @ref QStringList, @ref
+   * QVariantList, @ref QVariantMap and @tt{QList<QObject*>} values
+   * are exposed as read only views sharing the Qt container data,
+   * elements are converted on access. The @tt to_table() lua
+   * function returns a lua table copy of a view.
+   *
+   * When @ref ConvertByteBuffers is set, @ref QByteArray values are
+   * exposed as @ref ByteBuffer objects sharing the byte array data
+   * instead of being copied to lua strings.
+   */
+  inline void set_conversions(Conversions c);
+
+  /** Get current optional conversions flags. @see set_conversions */
+  inline Conversions get_conversions() const;
+
 public slots:
 
   /**
@@ -218,6 +260,9 @@ private:
 
   inline void output_str(const String &str);
 
+  // drain queued signals from foreign threads
+  void customEvent(QEvent *event);
+
   // get pointer to lua state object from lua state
   static State *get_this(lua_State *st);
 
@@ -238,6 +283,7 @@ private:
   static int lua_cmd_list(lua_State *st);
   static int lua_cmd_help(lua_State *st);
   static int lua_cmd_plugin(lua_State *st);
+  static int lua_cmd_to_table(lua_State *st);
 
   // lua meta methods functions
   static int lua_meta_item_add(lua_State *st);
@@ -257,17 +303,30 @@ private:
   static int lua_meta_item_call(lua_State *st);
   static int lua_meta_item_gc(lua_State *st);
 
-  // static member addresses are used as lua registry table keys
+  // push metatable for given UserData object
+  static void push_metatable(lua_State *st, const UserData &ud);
+
+  // static member addresses are used as lua registry table keys,
+  // _key_item_metatable is also used as marker in UserData metatables
   static char _key_item_metatable;
+  static char _key_item_cache;
+  static char _key_item_index;
   static char _key_this;
 
   // QObjects wrappers are referenced here
   wrapper_hash_t _whash;
 
+  // signals emitted from foreign threads are queued here
+  SignalQueue *_signal_queue;
+
   lua_State	*_lst;
+
+  Conversions _conversions;
 };
 
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QtLua::State::Conversions);
+
 #endif
 
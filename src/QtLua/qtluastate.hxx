@@ -42,6 +42,16 @@ namespace QtLua {
     output(str.to_qstring());
   }
 
+  void State::set_conversions(Conversions c)
+  {
+    _conversions = c;
+  }
+
+  State::Conversions State::get_conversions() const
+  {
+    return _conversions;
+  }
+
 }
 
 #endif
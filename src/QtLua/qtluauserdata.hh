@@ -23,6 +23,7 @@
 #define QTLUAUSERDATA_HH_
 
 #include <iostream>
+#include <typeinfo>
 
 #include <QList>
 #include <QHash>
@@ -76,10 +77,27 @@ public:
 
   virtual inline ~UserData();
 
-  /** Get a bare C++ typename from type */
+  /** Get a bare C++ typename from type. Demangled names are cached. */
   template <class X>
   static String type_name();
 
+  /**
+   * Get a process wide numeric identifier for the C++ type. Ids are
+   * allocated on first use, starting at 1, and remain valid until
+   * the program exits. This can be used for fast type checks.
+   * @see get_type_id
+   */
+  template <class X>
+  static int type_id();
+
+  /** Get numeric identifier of the object dynamic C++ type. The
+      registry is only locked on the first lookup of a type from a
+      given thread. @see type_id */
+  int get_type_id() const;
+
+  /** Get cached bare C++ typename associated with a type identifier. */
+  static String type_id_name(int id);
+
   /**
    * This function is called when a lua operator is used with a @ref
    * UserData object. The default implementation throws an error
@@ -122,11 +140,22 @@ public:
    * operation or the @ref Value::OpNewindex operation is supported and
    * an entry is associated to the given key.
    *
-   * The default implementation returns @tt{!meta_index(ls,
-   * key).is_nil()} or @tt false if @ref meta_index throws.
+   * The default implementation returns the result of @ref meta_find.
    */
   virtual bool meta_contains(State &ls, const Value &key);
 
+  /**
+   * This function performs a table read access without throwing when
+   * no entry is associated to the given key. It returns @tt false in
+   * this case and @tt true if @tt value has been set. This function
+   * is used internally when a failed lookup is not an error.
+   *
+   * The default implementation calls @ref meta_index and returns
+   * @tt false if it throws or returns a @tt nil value. Reimplementing
+   * this function avoids exception handling on lookup misses.
+   */
+  virtual bool meta_find(State &ls, const Value &key, Value &value);
+
   /**
    * This function is called when a function invokation operation is
    * performed on a userdata object. The default implementation throws
@@ -210,12 +239,35 @@ protected:
    */
   virtual void completion_patch(String &path, String &entry, int &offset);
 
+  /**
+   * This function returns a key used to share lua metatables between
+   * userdata values. The default implementation returns the C++ type
+   * info of the object. It may be reimplemented when values stored
+   * with @ref meta_index_cache depend on more than the C++ type.
+   */
+  virtual const void * get_class_key() const;
+
+  /**
+   * This function stores a value in the index cache of the object
+   * metatable. Subsequent lua table read access with the same key on
+   * any object sharing the metatable returns the cached value
+   * without calling @ref meta_index. It must only be used for values
+   * which do not depend on object state.
+   */
+  void meta_index_cache(State &ls, const Value &key, const Value &value);
+
 private:
 
+  /** Get registry identifier of a C++ type, registering it if needed. */
+  static int type_info_id(const std::type_info &ti);
+
   template <bool pop>
   static QtLua::Ref<UserData> get_ud_(lua_State *st, int i);
   /** Get @ref QtLua::UserData reference from lua stack element. */
   static QtLua::Ref<UserData> get_ud(lua_State *st, int i);
+  /** Get @ref QtLua::UserData reference from lua stack element or
+      a null reference if the element is not a QtLua::UserData. */
+  static QtLua::Ref<UserData> try_get_ud(lua_State *st, int i);
   /** Get @ref QtLua::UserData reference from lua stack element and pop stack */
   static QtLua::Ref<UserData> pop_ud(lua_State *st);
   /** Push a reference to QtLua::UserData on lua stack. */
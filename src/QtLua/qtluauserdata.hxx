@@ -22,10 +22,6 @@
 #ifndef QTLUAUSERDATA_HXX_
 #define QTLUAUSERDATA_HXX_
 
-#ifdef __GNUC__
-#include <cxxabi.h>
-#endif
-
 #include "Iterator"
 #include "Value"
 
@@ -38,12 +34,15 @@ namespace QtLua {
   template <class X>
   inline String UserData::type_name()
   {
-#ifdef __GNUC__
-    int s;
-    return String(abi::__cxa_demangle(typeid(X).name(), 0, 0, &s));
-#else
-    return String(typeid(X).name());
-#endif
+    static String name = type_id_name(type_id<X>());
+    return name;
+  }
+
+  template <class X>
+  inline int UserData::type_id()
+  {
+    static int id = type_info_id(typeid(X));
+    return id;
   }
 
 }
@@ -22,6 +22,7 @@
 #define QTLUAUSEROBJECT_HH_
 
 #include <QPointer>
+#include <QVector>
 
 #include "qtluauserdata.hh"
 #include "qtluaiterator.hh"
@@ -49,6 +50,10 @@ namespace QtLua {
    *
    * @example examples/cpp/userdata/userobject.cc:1
    *
+   * A name sorted index of the properties table is built on first
+   * access so that property lookup is a binary search; the table
+   * order is still used for iteration.
+   *
    * In the next example our class already needs to inherit from an
    * other @ref UserData based class for some reasons. We declare the
    * @ref UserObject class as a member and forward table accesses to
@@ -84,7 +89,14 @@ namespace QtLua {
 
     friend class UserObjectIterator;
 
-    int get_entry(const String &name);
+    struct entry_less
+    {
+      bool operator()(int a, int b) const;
+    };
+
+    static QVector<int> build_index();
+    static int find_entry(const char *name);
+    int get_entry(const Value &key);
     T *_obj;
 
     void completion_patch(String &path, String &entry, int &offset);
@@ -110,6 +122,7 @@ namespace QtLua {
 
     Value meta_index(State &ls, const Value &key);
     bool meta_contains(State &ls, const Value &key);
+    bool meta_find(State &ls, const Value &key, Value &value);
     void meta_newindex(State &ls, const Value &key, const Value &value);
     Ref<Iterator> new_iterator(State &ls);
     bool support(Value::Operation c) const;
@@ -22,6 +22,9 @@
 #ifndef QTLUAUSEROBJECT_HXX_
 #define QTLUAUSEROBJECT_HXX_
 
+#include <algorithm>
+#include <cstring>
+
 #include "qtluauserdata.hxx"
 #include "qtluaiterator.hxx"
 
@@ -40,24 +43,69 @@ namespace QtLua {
   }
 
   template <class T>
-  int UserObject<T>::get_entry(const String &name)
+  bool UserObject<T>::entry_less::operator()(int a, int b) const
+  {
+    return strcmp(T::_qtlua_properties_table[a].name,
+		  T::_qtlua_properties_table[b].name) < 0;
+  }
+
+  template <class T>
+  QVector<int> UserObject<T>::build_index()
+  {
+    QVector<int> index;
+
+    for (int i = 0; T::_qtlua_properties_table[i].name; i++)
+      index.push_back(i);
+
+    std::sort(index.begin(), index.end(), entry_less());
+    return index;
+  }
+
+  template <class T>
+  int UserObject<T>::find_entry(const char *name)
+  {
+    // properties table entries sorted by name, built on first lookup
+    static const QVector<int> index = build_index();
+
+    int l = 0, h = index.size();
+
+    while (l < h)
+      {
+	int m = (l + h) / 2;
+	int e = index[m];
+	int c = strcmp(name, T::_qtlua_properties_table[e].name);
+
+	if (c == 0)
+	  return e;
+	if (c < 0)
+	  h = m;
+	else
+	  l = m + 1;
+      }
+
+    return -1;
+  }
+
+  template <class T>
+  int UserObject<T>::get_entry(const Value &key)
   {
-    for (size_t i = 0; T::_qtlua_properties_table[i].name; i++)
-      if (name == T::_qtlua_properties_table[i].name)
-	return i;
+    int index = key.type() == Value::TString ? find_entry(key.to_cstring()) : -1;
+
+    if (index < 0)
       throw String("No such property `%::%'")
-	.arg(UserData::type_name<T>()).arg(name);
+	.arg(UserData::type_name<T>()).arg(key.to_string_p(false));
+
+    return index;
   }
 
   template <class T>
   Value UserObject<T>::meta_index(State &ls, const Value &key)
   {
-    String name = key.to_string();
-    int index = get_entry(name);
+    int index = get_entry(key);
 
     if (!T::_qtlua_properties_table[index].get)
       throw String("The `%::%' property is write only")
-	.arg(UserData::type_name<T>()).arg(name);
+	.arg(UserData::type_name<T>()).arg(T::_qtlua_properties_table[index].name);
 
     return (_obj->*T::_qtlua_properties_table[index].get)(ls);
   }
@@ -65,19 +113,28 @@ namespace QtLua {
   template <class T>
   bool UserObject<T>::meta_contains(State &ls, const Value &key)
   {
-    try {
-      get_entry(key.to_string());
-      return true;
-    } catch (String &e) {
+    return key.type() == Value::TString && find_entry(key.to_cstring()) >= 0;
+  }
+
+  template <class T>
+  bool UserObject<T>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    if (key.type() != Value::TString)
       return false;
-    }
+
+    int index = find_entry(key.to_cstring());
+
+    if (index < 0 || !T::_qtlua_properties_table[index].get)
+      return false;
+
+    value = (_obj->*T::_qtlua_properties_table[index].get)(ls);
+    return true;
   }
 
   template <class T>
   void UserObject<T>::meta_newindex(State &ls, const Value &key, const Value &value)
   {
-    String name = key.to_string();
-    int index = get_entry(name);
+    int index = get_entry(key);
 
     if (!T::_qtlua_properties_table[index].set)
       throw String("The `%::%' property is read only")
@@ -68,6 +68,8 @@ class Value
   friend class UserData;
   friend class TableIterator;
   friend class ValueRef;
+  friend class BindBase;
+  friend class Member;
   friend uint qHash(const Value &lv);
 
   /**
@@ -232,6 +234,20 @@ public:
 
   Q_DECLARE_FLAGS(Operations, Operation);
 
+  /**
+   * Specify how @ref QObject signal emissions are delivered to a
+   * connected lua value.
+   * @see connect
+   */
+  enum ConnectFlag
+    {
+      ConnectDefault  = 0x0000,	//< Call lua value on each signal emission
+      ConnectCoalesce = 0x0001,	//< Collapse emissions, latest arguments are delivered from the event loop
+      ConnectQueued   = 0x0002,	//< Queue emissions from any thread, deliver them in the State thread
+    };
+
+  Q_DECLARE_FLAGS(ConnectFlags, ConnectFlag);
+
   /**
    * @showcontent
    *
@@ -393,7 +409,8 @@ public:
   Value & operator=(QObject *obj);
 
   /**
-   * Convert a @ref QVariant to lua value.
+   * Convert a @ref QVariant to lua value. Variant lists, maps and
+   * hashes are converted recursively to lua tables.
    * @xsee {Qt/Lua types conversion}
    */
   Value & operator=(const QVariant &qv);
@@ -441,6 +458,10 @@ public:
   inline operator double () const;
   inline operator float () const;
 
+  /** Convert a lua number value to a @tt double. This function does
+      not throw, @tt false is returned if conversion fails. */
+  bool try_to_number(double &res) const;
+
   /** Convert a lua number value to an integer.
       Throw exception if conversion fails. @multiple */
   inline int to_integer() const;
@@ -556,12 +577,36 @@ public:
   inline operator Ref<X> () const;
 
   /**
-   * Convert a lua value to a @ref QVariant.
+   * Convert a lua value to a @ref QVariant. Lua tables are converted
+   * recursively: tables with keys 1 to n only give a @ref
+   * QVariantList, other tables give a @ref QVariantMap. Wrapped
+   * @ref QObject and @ref UserData objects are stored in the
+   * variant. An error is thrown for tables with cycles.
    * @xsee {Qt/Lua types conversion} @multiple
    */
   QVariant to_qvariant() const; 
   inline operator QVariant () const;
 
+  /** Convert a lua table to a @ref QVariantList, elements are
+      converted as done by @ref to_qvariant. */
+  QVariantList to_qvariantlist() const;
+
+  /** Convert a lua table to a @ref QVariantMap, elements are
+      converted as done by @ref to_qvariant. */
+  QVariantMap to_qvariantmap() const;
+
+  /** Convert a lua table to a @ref QVariantHash, elements are
+      converted as done by @ref to_qvariant. */
+  QVariantHash to_qvarianthash() const;
+
+  /**
+   * Get a pointer which identifies lua tables, functions and
+   * userdata values. @ref UserData values are identified by the
+   * address of the C++ object. The value can only be used for
+   * identity comparison. @return 0 for other lua types.
+   */
+  const void * to_pointer() const;
+
   /** Check if the value is @tt nil */
   inline bool is_nil() const;
 
@@ -581,6 +626,20 @@ public:
       name is extracted using the @ref UserData::get_type_name function. */
   String type_name_u() const;
 
+  /** Create a lua table with preallocated space for @tt
+      array_size entries indexed from 1 and @tt hash_size other
+      entries. */
+  static Value new_table(const State &ls, int array_size, int hash_size = 0);
+
+  /** Get lua table entry at integer index without invoking
+      metamethods. */
+  Value raw_get(int index) const;
+
+  /** Set lua table entry at integer index without invoking
+      metamethods. This is faster than assignment through a @ref
+      ValueRef when filling large tables. */
+  void raw_set(int index, const Value &value);
+
   /** Return the lua len of tables and strings. Return the result of
       the @ref OpLen operation on @ref UserData objects or 0 if not
       supported. */
@@ -606,11 +665,30 @@ public:
   /**
    * Connect a @ref QObject signal to a lua value. The value will be
    * called when the signal is emited.
+   *
+   * When the @ref ConnectCoalesce flag is used, signal emissions
+   * occuring before the lua value gets called are collapsed and only
+   * the latest signal arguments are delivered from the event
+   * loop. The @tt max_rate parameter can be used to limit the number
+   * of calls per second, it implies the @ref ConnectCoalesce flag
+   * when not zero.
+   *
+   * When the @ref ConnectQueued flag is used, signal emissions are
+   * copied in a lock-free queue and delivered in batches from the
+   * @ref State event loop, the lua value is never called during
+   * emission, even when the signal is emitted from the @ref State
+   * thread. This avoids allocation of a Qt queued call event for
+   * each emission; queue nodes are recycled and arguments are stored
+   * as @ref QVariant copies which share implicitly shared Qt data.
+   * Signal parameter types must be registered with the Qt meta type
+   * system.
+   *
    * @see disconnect
    * @see QObject::connect
    * @xsee{QObject wrapping}
    */
-  bool connect(QObject *obj, const char *signal);
+  bool connect(QObject *obj, const char *signal,
+	       ConnectFlags flags = ConnectDefault, unsigned int max_rate = 0);
 
   /**
    * Disconnect a @ref QObject signal from a lua value.
@@ -655,6 +733,7 @@ private:
 }
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QtLua::Value::Operations);
+Q_DECLARE_OPERATORS_FOR_FLAGS(QtLua::Value::ConnectFlags);
 
 #endif
 
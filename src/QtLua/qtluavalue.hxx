@@ -221,7 +221,7 @@ namespace QtLua {
   {
     *this = Value(ls, TTable);
     for (int i = 0; i < list.size(); i++)
-      (*this)[i+1] = list.at(i);
+      (*this)[i+1] = Value(ls, list.at(i));
   }
 
   template <typename ListContainer>
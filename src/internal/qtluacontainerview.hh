@@ -0,0 +1,91 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef QTLUACONTAINERVIEW_HH_
+#define QTLUACONTAINERVIEW_HH_
+
+#include <QtLua/qtluauserdata.hh>
+#include <QtLua/qtluavalue.hh>
+
+namespace QtLua {
+
+/**
+ * @short Read only lua view of a Qt container value
+ * @header internal/ContainerView
+ * @module {Container proxies}
+ * @internal
+ *
+ * This internal class template exposes a container value returned
+ * by a @ref QObject property or method to lua without building a
+ * lua table. It is used when the @ref State::ConvertContainerViews
+ * conversion flag is set.
+ *
+ * The container is stored as an implicitly shared copy attached to
+ * a read only container proxy class, @ref QListProxyRo or @ref
+ * QHashProxyRo. Creating the view does not copy elements; the data
+ * is duplicated by Qt only if the original container is modified
+ * later. Elements are converted to lua values on access. A lua
+ * table is built with the @tt to_table() lua function or the unary
+ * minus operator.
+ */
+
+template <class Container, class Proxy>
+class ContainerView : public Proxy
+{
+public:
+  QTLUA_REFTYPE(ContainerView);
+
+  ContainerView(const Container &c)
+    : _copy(c)
+  {
+    Proxy::set_container(&_copy);
+  }
+
+  /** Get viewed container */
+  inline const Container & get_container() const
+  {
+    return _copy;
+  }
+
+  /** Get container if @tt v holds a view of the same container type. */
+  static bool get(const Value &v, Container &c)
+  {
+    if (v.type() != Value::TUserData)
+      return false;
+
+    Ref<UserData> ud = v.to_userdata_null();
+    ContainerView *cv = dynamic_cast<ContainerView*>(ud.ptr());
+
+    if (!cv)
+      return false;
+
+    c = cv->_copy;
+    return true;
+  }
+
+private:
+  Container _copy;
+};
+
+}
+
+#endif
+
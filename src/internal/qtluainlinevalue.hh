@@ -0,0 +1,105 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef QTLUAINLINEVALUE_HH_
+#define QTLUAINLINEVALUE_HH_
+
+#include <QtLua/qtluauserdata.hh>
+#include <QtLua/qtluavalue.hh>
+
+namespace QtLua {
+
+  class State;
+
+/**
+ * @short Inline Qt value type userdata class
+ * @header internal/InlineValue
+ * @module {QObject wrapping}
+ * @internal
+ *
+ * This internal class template stores a small Qt value type like
+ * @ref QPoint, @ref QSize, @ref QRect or @ref QColor inline in a
+ * @ref UserData object. It is used in place of numeric lua tables
+ * when the @ref State::ConvertValueTypes conversion flag is set.
+ *
+ * Fields can be read and written by name (@tt{r.x}, @tt{r.width},
+ * ...) and arithmetic operators are available where Qt defines
+ * them. Values of this type are converted back to Qt without any
+ * field by field parsing.
+ *
+ * This template is instantiated in @tt qtluainlinevalue.cc for
+ * @ref QPoint, @ref QPointF, @ref QSize, @ref QSizeF, @ref QRect,
+ * @ref QRectF and @ref QColor only.
+ */
+
+template <class X>
+class InlineValue : public UserData
+{
+public:
+  QTLUA_REFTYPE(InlineValue);
+
+  inline InlineValue(const X &value)
+    : _value(value)
+  {
+  }
+
+  /** Get stored value */
+  inline const X & get_value() const
+  {
+    return _value;
+  }
+
+  /** Create a new value type object holding a copy of @tt value. */
+  static Value new_value(State &ls, const X &value);
+
+  /** Get stored value if @tt v holds an @tt{InlineValue<X>} object. */
+  static bool get(const Value &v, X &value);
+
+private:
+  Value meta_index(State &ls, const Value &key);
+  bool meta_find(State &ls, const Value &key, Value &value);
+  void meta_newindex(State &ls, const Value &key, const Value &value);
+  Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b);
+  bool support(Value::Operation c) const;
+  String get_type_name() const;
+  String get_value_str() const;
+  bool operator==(const UserData &ud);
+
+  /** @internal named field accessors */
+  struct Field
+  {
+    const char *_name;
+    qreal (*_get)(const X &x);
+    void (*_set)(X &x, qreal v);
+  };
+
+  static const Field _fields[];
+  static const char _name[];
+
+  static const Field * find_field(const Value &key);
+
+  X _value;
+};
+
+}
+
+#endif
+
@@ -24,13 +24,17 @@
 
 #include <QObject>
 #include <QPointer>
+#include <QVector>
 
 #include <QtLua/qtluauserdata.hh>
 #include <QtLua/qtluametatype.hh>
 
+struct lua_State;
+
 namespace QtLua {
 
   class QObjectWrapper;
+  class MappedFileProxy;
   class Value;
 
 /**
@@ -45,6 +49,7 @@ namespace QtLua {
   class Member : public UserData
   {
     friend class QObjectWrapper;
+    friend class MappedFileProxy;
     friend class Value;
 
   public:
@@ -59,12 +64,49 @@ namespace QtLua {
     virtual void assign(QObjectWrapper &qow, const Value &value);
     virtual Value access(QObjectWrapper &qow);
 
+    /** @internal Get value at given lua stack index, used by converters. */
+    static Value stack_value(State &ls, int index);
+    /** @internal Push value on lua stack, used by converters. */
+    static void stack_push(const Value &v);
+
+    /** Push Qt value of given meta type on lua stack. A nil value is
+	pushed and @tt false returned if no converter is available. */
+    static bool raw_push(State &ls, int type, const void *data);
+    /** Convert lua stack value at given index to Qt value of given
+	meta type. Return @tt false if no converter is available. */
+    static bool raw_pull(State &ls, int index, int type, void *data);
+
   protected:
     static Value raw_get_object(State &ls, int type, const void *data);
     static bool raw_set_object(int type, void *data, const Value &v);
 
     const QMetaObject *_mo;
     int _index;
+
+  private:
+    friend void metatype_register(int type, metatype_void_t *mt);
+    friend void metatype_unregister(int type);
+
+    typedef void push_t(State &ls, lua_State *st, const void *data);
+    typedef void pull_t(State &ls, lua_State *st, int index, void *data);
+
+    /** Qt/lua converter table entry, indexed by Qt meta type id */
+    struct Converter
+    {
+      Converter()
+	: _push(0), _pull(0), _meta(0)
+      {
+      }
+
+      push_t *_push;
+      pull_t *_pull;
+      metatype_void_t *_meta;	//< user registered handler
+    };
+
+    typedef QVector<Converter> converters_t;
+
+    static converters_t build_converters();
+    static converters_t & converters();
   };
 
 }
@@ -24,8 +24,12 @@
 
 #include <QObject>
 #include <QMetaObject>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QVariant>
 
 #include <QtLua/qtluauserdata.hh>
+#include <internal/qtluasignalqueue.hh>
 
 namespace QtLua {
 
@@ -84,10 +88,13 @@ namespace QtLua {
 
     // internal use only
     int qt_metacall(QMetaObject::Call c, int id, void **args);
-    void _lua_connect(int sigindex, const Value &v);
+    void _lua_connect(int sigindex, const Value &v,
+		      Value::ConnectFlags flags = Value::ConnectDefault,
+		      unsigned int max_rate = 0);
     bool _lua_disconnect(int sigindex, const Value &v);
     void _lua_disconnect_all(int sigindex);
     void _lua_disconnect_all();
+    static void _lua_queue_drain(State &ls);
 
     ~QObjectWrapper();
   private:
@@ -98,6 +105,7 @@ namespace QtLua {
     QObjectWrapper(const QObjectWrapper &qow);
 
     Value meta_index(State &ls, const Value &key);
+    const void * get_class_key() const;
     void meta_newindex(State &ls, const Value &key, const Value &value);
     Ref<Iterator> new_iterator(State &ls);
     bool support(Value::Operation c) const;
@@ -107,22 +115,58 @@ namespace QtLua {
     String get_value_str() const;
     void obj_destroyed();
     void ref_drop(int count);
+    void timerEvent(QTimerEvent *event);
 
   private:
 
     struct LuaSlot
     {
-      inline LuaSlot(const Value &v, int sigindex);
+      inline LuaSlot(const Value &v, int sigindex, const QVector<int> &types,
+		     Value::ConnectFlags flags, int interval);
 
       Value _value;
       int _sigindex;
+      /** signal parameters meta types */
+      QVector<int> _types;
+      /** unique connection serial number, used to match queued signals */
+      int _serial;
+      /** @ref SignalRelay entry id of queued connection or -1 */
+      int _relay_id;
+      Value::ConnectFlags _flags;
+      /** minimum delay between two coalesced calls in ms */
+      int _interval;
+      /** pending delivery timer id or 0 */
+      int _timer;
+      /** time of last coalesced call */
+      QElapsedTimer _last;
+      /** latest signal arguments waiting for delivery */
+      QVector<QVariant> _args;
     };
 
     typedef QHash<int, LuaSlot> lua_slots_hash_t;
+    /** connected lua values identity to slot ids */
+    typedef QMultiHash<const void *, int> lua_slots_index_t;
+    typedef QHash<int, lua_slots_index_t> lua_signals_hash_t;
+
+    Value lua_sender() const;
+    void lua_slot_call(const Value &value, const Value::List &args);
+    void lua_slot_call(const Value &value, const QVariant *args, int count);
+    void lua_slot_coalesce(int slot_id, LuaSlot &slot);
+    void lua_slot_cancel(LuaSlot &slot);
+    void lua_slot_remove(int slot_id);
+    void lua_slot_disconnect(int slot_id, LuaSlot &slot);
+    void lua_slot_unrelay(LuaSlot &slot);
+    void lua_slot_dequeue(SignalQueue::Node *n);
 
     State &_ls;
     QObject *_obj;
     lua_slots_hash_t _lua_slots;
+    /** per signal index of lua slots */
+    lua_signals_hash_t _lua_signals;
+    /** pending coalesced deliveries, timer id to slot id */
+    QHash<int, int> _lua_timers;
+    /** released slot ids available for reuse */
+    QVector<int> _lua_free_slots;
     int _lua_next_slot;
     bool _reparent;
     bool _delete;
@@ -54,10 +54,18 @@ namespace QtLua {
     return _ls;
   }
 
-  QObjectWrapper::LuaSlot::LuaSlot(const Value &v, int sigindex)
+  QObjectWrapper::LuaSlot::LuaSlot(const Value &v, int sigindex, const QVector<int> &types,
+				   Value::ConnectFlags flags, int interval)
     : _value(v),
-      _sigindex(sigindex)
+      _sigindex(sigindex),
+      _types(types),
+      _serial(0),
+      _relay_id(-1),
+      _flags(flags),
+      _interval(interval),
+      _timer(0)
   {
+    _last.invalidate();
   }
 
 }
@@ -0,0 +1,196 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef QTLUASIGNALQUEUE_HH_
+#define QTLUASIGNALQUEUE_HH_
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QEvent>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QVariant>
+#include <QVarLengthArray>
+#include <QVector>
+
+namespace QtLua {
+
+/**
+ * @short Lock-free queue of signal emissions
+ * @header internal/SignalQueue
+ * @module {QObject wrapping}
+ * @internal
+ *
+ * This internal class implements a multiple producers, single
+ * consumer intrusive queue used to deliver Qt signals emitted from
+ * any thread to lua values connected with the @ref
+ * Value::ConnectQueued flag. Signal arguments are copied in @ref
+ * QVariant objects by the emitting thread.
+ *
+ * A single event is posted to the receiver object when the queue
+ * becomes non-empty; the receiver thread then drains queued nodes in
+ * batches. Drained nodes are kept in a pool and reused so that no
+ * allocation is performed on emission once the pool is warm.
+ */
+
+  class SignalQueue
+  {
+  public:
+
+    struct Node
+    {
+      QAtomicPointer<Node> _next;
+      Node *_pool_next;
+      QObject *_sender;
+      int _slot_id;
+      int _serial;
+      QVarLengthArray<QVariant, 4> _args;
+    };
+
+    /** Create a queue, events are posted to the receiver object. */
+    inline SignalQueue(QObject *receiver);
+    inline ~SignalQueue();
+
+    /** Event type posted to receiver object */
+    static inline QEvent::Type event_type();
+
+    /** Get a node from the pool or allocate a new one, may be
+	called from any thread. */
+    inline Node * alloc();
+
+    /** Push a node on the queue, may be called from any thread. */
+    inline void push(Node *n);
+
+    /** Pop a node from the queue, must only be called from receiver
+	thread. Returns 0 if queue is empty. */
+    inline Node * pop();
+
+    /** Release a popped node, must only be called from receiver
+	thread. Nodes are returned to the pool by @ref release_flush. */
+    inline void release(Node *n);
+
+    /** Return released nodes to the pool. */
+    inline void release_flush();
+
+    /** Must be called by receiver thread before draining the queue. */
+    inline void drain_begin();
+
+    /** Must be called by receiver thread when leaving some nodes in
+	the queue after draining a batch. */
+    inline void drain_defer();
+
+  private:
+    /** maximum number of pooled nodes */
+    static const int max_pool = 256;
+
+    inline void enqueue(Node *n);
+    inline void notify();
+    static inline Node * load_acquire(QAtomicPointer<Node> &p);
+
+    QObject *_receiver;
+    QAtomicPointer<Node> _head;
+    Node *_tail;
+    Node _stub;
+    QAtomicInt _notified;
+
+    /** pool of free nodes, protected by lock */
+    QMutex _pool_lock;
+    Node *_pool;
+    int _pool_size;
+    /** nodes released by receiver thread, not yet in pool */
+    Node *_released;
+  };
+
+/**
+ * @short Receiver of lua connections with queued delivery
+ * @header internal/SignalQueue
+ * @module {QObject wrapping}
+ * @internal
+ *
+ * Signals connected with the @ref Value::ConnectQueued flag are
+ * directly connected to the single instance of this class instead of
+ * being connected to a @ref QObjectWrapper object. The emitting
+ * thread copies signal arguments in a node pushed on the @ref
+ * SignalQueue of the target @ref State. Emissions from the @ref State
+ * thread are queued as well so that delivery order is preserved.
+ *
+ * With a direct connection, an emitting thread may enter the
+ * receiver after the connection has been removed by an other
+ * thread. The relay object is never destroyed and relay ids are
+ * never reused, so that such late calls only find a missing entry.
+ *
+ * Entries are spread over independently locked shards selected by
+ * relay id, emissions on different connections do not contend on a
+ * common lock. An entry is removed under its shard lock before the
+ * associated queue is destroyed.
+ */
+
+  class SignalRelay : public QObject
+  {
+  public:
+
+    struct Entry
+    {
+      SignalQueue *_queue;
+      QObject *_sender;
+      int _slot_id;
+      int _serial;
+      /** signal parameters meta types */
+      QVector<int> _types;
+    };
+
+    /** Get relay object */
+    static SignalRelay & instance();
+
+    /** Add a relay entry, returns a relay id */
+    int add(const Entry &e);
+
+    /** Remove a relay entry, must be called after signal disconnection. */
+    void remove(int relay_id);
+
+    /** Get method index to use on connection for given relay id */
+    inline int method_index(int relay_id) const;
+
+    int qt_metacall(QMetaObject::Call c, int id, void **qt_args);
+
+  private:
+    SignalRelay();
+
+    struct Shard
+    {
+      QMutex _lock;
+      QHash<int, Entry> _entries;
+    };
+
+    /** number of entry shards, must be a power of 2 */
+    static const int shard_count = 64;
+
+    inline Shard & shard(int relay_id);
+
+    Shard _shards[shard_count];
+    QAtomicInt _next_id;
+  };
+
+}
+
+#endif
+
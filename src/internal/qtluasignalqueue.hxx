@@ -0,0 +1,193 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#ifndef QTLUASIGNALQUEUE_HXX_
+#define QTLUASIGNALQUEUE_HXX_
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+
+namespace QtLua {
+
+  SignalQueue::SignalQueue(QObject *receiver)
+    : _receiver(receiver),
+      _head(&_stub),
+      _tail(&_stub),
+      _notified(0),
+      _pool(0),
+      _pool_size(0),
+      _released(0)
+  {
+    _stub._next = 0;
+  }
+
+  SignalQueue::~SignalQueue()
+  {
+    while (Node *n = pop())
+      delete n;
+
+    release_flush();
+
+    while (Node *n = _pool)
+      {
+	_pool = n->_pool_next;
+	delete n;
+      }
+  }
+
+  QEvent::Type SignalQueue::event_type()
+  {
+    static const QEvent::Type type = (QEvent::Type)QEvent::registerEventType();
+    return type;
+  }
+
+  SignalQueue::Node * SignalQueue::load_acquire(QAtomicPointer<Node> &p)
+  {
+    // Qt4 atomic pointers do not provide a plain load with acquire semantic
+    return p.fetchAndAddAcquire(0);
+  }
+
+  void SignalQueue::enqueue(Node *n)
+  {
+    n->_next.fetchAndStoreRelaxed(0);
+    Node *prev = _head.fetchAndStoreOrdered(n);
+    prev->_next.fetchAndStoreRelease(n);
+  }
+
+  void SignalQueue::notify()
+  {
+    // only post an event when no drain is pending yet
+    if (_notified.testAndSetOrdered(0, 1))
+      QCoreApplication::postEvent(_receiver, new QEvent(event_type()));
+  }
+
+  SignalQueue::Node * SignalQueue::alloc()
+  {
+    {
+      QMutexLocker locker(&_pool_lock);
+      Node *n = _pool;
+
+      if (n)
+	{
+	  _pool = n->_pool_next;
+	  _pool_size--;
+	  return n;
+	}
+    }
+
+    return new Node;
+  }
+
+  void SignalQueue::release(Node *n)
+  {
+    // drop references to shared argument data, keep array storage
+    n->_args.clear();
+    n->_pool_next = _released;
+    _released = n;
+  }
+
+  void SignalQueue::release_flush()
+  {
+    QMutexLocker locker(&_pool_lock);
+
+    while (Node *n = _released)
+      {
+	_released = n->_pool_next;
+
+	if (_pool_size < max_pool)
+	  {
+	    n->_pool_next = _pool;
+	    _pool = n;
+	    _pool_size++;
+	  }
+	else
+	  {
+	    delete n;
+	  }
+      }
+  }
+
+  void SignalQueue::push(Node *n)
+  {
+    enqueue(n);
+    notify();
+  }
+
+  SignalQueue::Node * SignalQueue::pop()
+  {
+    Node *tail = _tail;
+    Node *next = load_acquire(tail->_next);
+
+    if (tail == &_stub)
+      {
+	if (!next)
+	  return 0;
+	_tail = next;
+	tail = next;
+	next = load_acquire(next->_next);
+      }
+
+    if (next)
+      {
+	_tail = next;
+	return tail;
+      }
+
+    // a producer is in the middle of a push, it will notify again
+    if (tail != load_acquire(_head))
+      return 0;
+
+    enqueue(&_stub);
+    next = load_acquire(tail->_next);
+
+    if (next)
+      {
+	_tail = next;
+	return tail;
+      }
+
+    return 0;
+  }
+
+  void SignalQueue::drain_begin()
+  {
+    _notified.fetchAndStoreOrdered(0);
+  }
+
+  void SignalQueue::drain_defer()
+  {
+    notify();
+  }
+
+  SignalRelay::Shard & SignalRelay::shard(int relay_id)
+  {
+    return _shards[relay_id & (shard_count - 1)];
+  }
+
+  int SignalRelay::method_index(int relay_id) const
+  {
+    return metaObject()->methodCount() + relay_id;
+  }
+
+}
+
+#endif
+
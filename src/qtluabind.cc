@@ -0,0 +1,294 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <cstring>
+
+extern "C" {
+#include <lua.h>
+}
+
+#include <QtLua/Bind>
+#include <QtLua/State>
+#include <QtLua/UserData>
+
+namespace QtLua {
+
+void BindBase::register_(State &ls, const String &path, cfunction_t f,
+			 const void *data, size_t size)
+{
+  lua_State *st = ls._lst;
+
+  // upvalue 1 holds a copy of the function pointer, upvalue 2 the State
+  void *d = lua_newuserdata(st, size);
+  std::memcpy(d, data, size);
+  lua_pushlightuserdata(st, &ls);
+  lua_pushcclosure(st, f, 2);
+
+  Value v(-1, &ls);
+  lua_pop(st, 1);
+
+  ls.set_global(path, v);
+}
+
+void BindBase::get_data(lua_State *st, void *data, size_t size)
+{
+  std::memcpy(data, lua_touserdata(st, lua_upvalueindex(1)), size);
+}
+
+State & BindBase::state(lua_State *st)
+{
+  return *static_cast<State*>(lua_touserdata(st, lua_upvalueindex(2)));
+}
+
+void BindBase::check_count(lua_State *st, int count, int self)
+{
+  int n = lua_gettop(st) - self;
+
+  if (n < count)
+    throw String("Missing argument(s), % arguments expected").arg(count);
+
+  if (n > count)
+    throw String("Too many argument(s), % arguments expected").arg(count);
+}
+
+void BindBase::error(lua_State *st, const String &e)
+{
+  lua_pushstring(st, e.constData());
+  lua_error(st);
+}
+
+double BindBase::to_number(lua_State *st, int i)
+{
+  if (!lua_isnumber(st, i))
+    throw String("Wrong type for argument %, lua::number expected instead of lua::%.")
+      .arg(i).arg(lua_typename(st, lua_type(st, i)));
+
+  return lua_tonumber(st, i);
+}
+
+bool BindBase::to_boolean(lua_State *st, int i)
+{
+  return lua_toboolean(st, i);
+}
+
+const char * BindBase::to_cstring(lua_State *st, int i)
+{
+  if (!lua_isstring(st, i))
+    throw String("Wrong type for argument %, lua::string expected instead of lua::%.")
+      .arg(i).arg(lua_typename(st, lua_type(st, i)));
+
+  // convert numbers in place, stack slot keeps string alive
+  return lua_tostring(st, i);
+}
+
+String BindBase::to_string(lua_State *st, int i)
+{
+  size_t len;
+  const char *s;
+
+  if (!lua_isstring(st, i))
+    throw String("Wrong type for argument %, lua::string expected instead of lua::%.")
+      .arg(i).arg(lua_typename(st, lua_type(st, i)));
+
+  s = lua_tolstring(st, i, &len);
+  return String(s, len);
+}
+
+Value BindBase::to_value(lua_State *st, int i)
+{
+  return Value(i, &state(st));
+}
+
+UserData * BindBase::to_userdata(lua_State *st, int i)
+{
+  bool ours = false;
+
+  // all UserData metatables contain a marker entry
+  if (lua_type(st, i) == LUA_TUSERDATA && lua_getmetatable(st, i))
+    {
+      lua_pushlightuserdata(st, &State::_key_item_metatable);
+      lua_rawget(st, -2);
+      ours = lua_toboolean(st, -1);
+      lua_pop(st, 2);
+    }
+
+  if (!ours)
+    throw String("Wrong type for method object, QtLua::UserData expected instead of lua::%.")
+      .arg(lua_typename(st, lua_type(st, i)));
+
+  // object is kept alive by the stack slot during the call
+  return static_cast<UserData::ptr *>(lua_touserdata(st, i))->ptr();
+}
+
+void BindBase::push_number(lua_State *st, double n)
+{
+  lua_pushnumber(st, n);
+}
+
+void BindBase::push_boolean(lua_State *st, bool b)
+{
+  lua_pushboolean(st, b);
+}
+
+void BindBase::push_cstring(lua_State *st, const char *s)
+{
+  if (s)
+    lua_pushstring(st, s);
+  else
+    lua_pushnil(st);
+}
+
+void BindBase::push_string(lua_State *st, const char *s, int len)
+{
+  lua_pushlstring(st, s, len);
+}
+
+void BindBase::push_value(lua_State *st, const Value &v)
+{
+  v.push_value();
+}
+
+lua_State * BindBase::stack(State &ls)
+{
+  return ls._lst;
+}
+
+void BindBase::new_table(lua_State *st, int array_size)
+{
+  lua_createtable(st, array_size, 0);
+}
+
+void BindBase::raw_seti(lua_State *st, int n)
+{
+  lua_rawseti(st, -2, n);
+}
+
+Value BindBase::pop_value(State &ls)
+{
+  Value res(-1, &ls);
+  lua_pop(ls._lst, 1);
+  return res;
+}
+
+int BindBase::lookup(const char * const *names, int count, const Value &key)
+{
+  if (key.type() != Value::TString)
+    return -1;
+
+  const char *name = key.to_cstring();
+  int first = 0, last = count - 1;
+
+  while (first <= last)
+    {
+      int middle = (first + last) / 2;
+      int c = std::strcmp(name, names[middle]);
+
+      if (c == 0)
+	return middle;
+      if (c < 0)
+	last = middle - 1;
+      else
+	first = middle + 1;
+    }
+
+  return -1;
+}
+
+void BindBase::register_member(State &ls, const void *class_key, const char *name,
+			       cfunction_t f, const void *data, size_t size)
+{
+  lua_State *st = ls._lst;
+
+  lua_pushlightuserdata(st, const_cast<void*>(class_key));
+  lua_rawget(st, LUA_REGISTRYINDEX);
+
+  if (lua_isnil(st, -1))
+    {
+      lua_pop(st, 1);
+      lua_newtable(st);
+      lua_pushlightuserdata(st, const_cast<void*>(class_key));
+      lua_pushvalue(st, -2);
+      lua_rawset(st, LUA_REGISTRYINDEX);
+    }
+
+  lua_pushstring(st, name);
+
+  void *d = lua_newuserdata(st, size);
+  std::memcpy(d, data, size);
+  lua_pushlightuserdata(st, &ls);
+  lua_pushcclosure(st, f, 2);
+
+  lua_rawset(st, -3);
+  lua_pop(st, 1);
+}
+
+static bool push_class_member(lua_State *st, const void *class_key, const Value &key)
+{
+  lua_pushlightuserdata(st, const_cast<void*>(class_key));
+  lua_rawget(st, LUA_REGISTRYINDEX);
+
+  if (!lua_istable(st, -1))
+    {
+      lua_pop(st, 1);
+      return false;
+    }
+
+  key.push_value();
+  lua_rawget(st, -2);
+  lua_remove(st, -2);
+
+  return true;
+}
+
+Value BindBase::class_member(State &ls, const void *class_key, const Value &key)
+{
+  lua_State *st = ls._lst;
+
+  if (!push_class_member(st, class_key, key))
+    throw String("Members of bound class are not registered in this State.");
+
+  Value res(-1, &ls);
+  lua_pop(st, 1);
+
+  return res;
+}
+
+bool BindBase::find_class_member(State &ls, const void *class_key,
+				 const Value &key, Value &value)
+{
+  lua_State *st = ls._lst;
+
+  if (!push_class_member(st, class_key, key))
+    return false;
+
+  if (lua_isnil(st, -1))
+    {
+      lua_pop(st, 1);
+      return false;
+    }
+
+  value = Value(-1, &ls);
+  lua_pop(st, 1);
+
+  return true;
+}
+
+}
+
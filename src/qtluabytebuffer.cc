@@ -0,0 +1,222 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+
+#include <QtLua/ByteBuffer>
+
+namespace QtLua {
+
+  const ProxyMethod<ByteBuffer>::Entry ByteBuffer::_methods[] = {
+    { "byte", &ByteBuffer::method_byte },
+    { "find", &ByteBuffer::method_find },
+    { "sub", &ByteBuffer::method_sub },
+    { "tostring", &ByteBuffer::method_tostring },
+    { 0, 0 }
+  };
+
+  ByteBuffer::ByteBuffer(const QByteArray &data)
+    : _owner(data),
+      _data(data)
+  {
+  }
+
+  ByteBuffer::ByteBuffer(const QByteArray &owner, int pos, int len)
+    : _owner(owner),
+      _data(QByteArray::fromRawData(owner.constData() + pos, len))
+  {
+  }
+
+  bool ByteBuffer::get(const Value &v, QByteArray &data)
+  {
+    if (v.type() != Value::TUserData)
+      return false;
+
+    Ref<UserData> ud = v.to_userdata_null();
+    ByteBuffer *b = dynamic_cast<ByteBuffer*>(ud.ptr());
+
+    if (!b)
+      return false;
+
+    // sub range buffers do not own their data
+    data = b->_data.constData() == b->_owner.constData() &&
+      b->_data.size() == b->_owner.size()
+      ? b->_owner : QByteArray(b->_data.constData(), b->_data.size());
+    return true;
+  }
+
+  void ByteBuffer::get_range(const Value::List &args, int n, int &first, int &last) const
+  {
+    int size = _data.size();
+
+    first = Function::get_arg<int>(args, n, 1);
+    last = Function::get_arg<int>(args, n + 1, -1);
+
+    // negative indices are relative to buffer end as in lua string library
+    if (first < 0)
+      first += size + 1;
+    if (last < 0)
+      last += size + 1;
+
+    if (first < 1)
+      first = 1;
+    if (last > size)
+      last = size;
+  }
+
+  Value ByteBuffer::meta_index(State &ls, const Value &key)
+  {
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<ByteBuffer>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  meta_index_cache(ls, key, m);
+	return m;
+      }
+
+    unsigned int index = (unsigned int)key.to_number() - 1;
+
+    if (index < (unsigned int)_data.size())
+      return Value(ls, (int)(uchar)_data.at(index));
+    else
+      return Value(ls);
+  }
+
+  bool ByteBuffer::meta_contains(State &ls, const Value &key)
+  {
+    double n;
+
+    if (!key.try_to_number(n))
+      return false;
+
+    unsigned int index = (unsigned int)n - 1;
+
+    return index < (unsigned int)_data.size();
+  }
+
+  Value ByteBuffer::meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, _data.size());
+      case Value::OpUnm:
+	return Value(ls, String(_data));
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  bool ByteBuffer::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpLen:
+      case Value::OpUnm:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  String ByteBuffer::get_type_name() const
+  {
+    return "QtLua::ByteBuffer";
+  }
+
+  String ByteBuffer::get_value_str() const
+  {
+    return String("% bytes").arg(_data.size());
+  }
+
+  Value::List ByteBuffer::method_byte(State &ls, const Value::List &args)
+  {
+    int first, last;
+
+    get_range(args, 1, first, last);
+
+    if (args.size() < 3)
+      last = qMin(first, _data.size());
+
+    Value::List r;
+
+    for (int i = first; i <= last; i++)
+      r.push_back(Value(ls, (int)(uchar)_data.at(i - 1)));
+
+    return r;
+  }
+
+  Value::List ByteBuffer::method_find(State &ls, const Value::List &args)
+  {
+    const Value &s = Function::get_arg<const Value &>(args, 1);
+    int init = Function::get_arg<int>(args, 2, 1);
+    QByteArray needle;
+
+    if (!get(s, needle))
+      needle = s.to_string();
+
+    if (init < 0)
+      init += _data.size() + 1;
+    if (init < 1)
+      init = 1;
+
+    int i = _data.indexOf(needle, init - 1);
+
+    if (i < 0)
+      return Value(ls);
+
+    return Value(ls, i + 1);
+  }
+
+  Value::List ByteBuffer::method_sub(State &ls, const Value::List &args)
+  {
+    int first, last;
+
+    get_range(args, 1, first, last);
+
+    if (last < first)
+      return Value(ls, QTLUA_REFNEW(ByteBuffer, QByteArray()));
+
+    int len = last - first + 1;
+
+    if (len == _data.size())
+      return Value(ls, *this);
+
+    return Value(ls, QTLUA_REFNEW(ByteBuffer, _owner,
+				  _data.constData() - _owner.constData() + first - 1, len));
+  }
+
+  Value::List ByteBuffer::method_tostring(State &ls, const Value::List &args)
+  {
+    int first, last;
+
+    get_range(args, 1, first, last);
+
+    if (last < first)
+      return Value(ls, String());
+
+    if (last - first + 1 == _data.size())
+      return Value(ls, String(_data));
+
+    return Value(ls, String(_data.constData() + first - 1, last - first + 1));
+  }
+
+}
+
@@ -24,7 +24,11 @@
 
 namespace QtLua {
 
+  // routing cache is dropped when it grows beyond this size
+  static const int max_routes = 256;
+
   DispatchProxy::DispatchProxy()
+    : _route_cache(false)
   {
   }
 
@@ -45,30 +49,113 @@ namespace QtLua {
     return UserData::meta_operation(ls, op, a, b);
   }
 
-  Value DispatchProxy::meta_index(State &ls, const Value &key)
+  void DispatchProxy::set_route_cache(bool enabled)
   {
-    bool supported = false;
+    _route_cache = enabled;
+    invalidate_routes();
+  }
 
-    foreach (const TargetBase *t, _targets)
+  void DispatchProxy::invalidate_routes()
+  {
+    _index_routes.clear();
+    _newindex_routes.clear();
+  }
+
+  void DispatchProxy::add_route(routes_t &routes, const QByteArray &key, int index)
+  {
+    if (routes.size() >= max_routes)
+      routes.clear();
+
+    // deep copy of key which may refer to lua string storage
+    routes.insert(QByteArray(key.constData(), key.size()), index);
+  }
+
+  bool DispatchProxy::find(State &ls, const Value &key, Value &value, bool &supported)
+  {
+    QByteArray k;
+
+    if (_route_cache)
       {
+	k = route_key(key);
+
+	if (!k.isNull())
+	  {
+	    routes_t::const_iterator r = _index_routes.constFind(k);
+
+	    if (r != _index_routes.constEnd())
+	      {
+		supported = true;
+
+		if (_targets[r.value()]->_meta_find(ls, key, value))
+		  return true;
+
+		// stale route, earlier targets may now hold the entry
+		_index_routes.remove(k);
+	      }
+	  }
+      }
+
+    for (int i = 0; i < _targets.size(); i++)
+      {
+	const TargetBase *t = _targets[i];
+
 	if ((t->_ops & Value::OpIndex) && t->_support(Value::OpIndex))
 	  {
 	    supported = true;
 
-	    if (t->_meta_contains(ls, key))
-	      return t->_meta_index(ls, key);
+	    if (t->_meta_find(ls, key, value))
+	      {
+		if (!k.isNull())
+		  add_route(_index_routes, k, i);
+		return true;
+	      }
 	  }
       }
 
+    return false;
+  }
+
+  Value DispatchProxy::meta_index(State &ls, const Value &key)
+  {
+    bool supported = false;
+    Value value(ls);
+
+    if (find(ls, key, value, supported))
+      return value;
+
     return supported ? Value(ls) : UserData::meta_index(ls, key);
   }
 
   void DispatchProxy::meta_newindex(State &ls, const Value &key, const Value &value)
   {
     bool shadow = false;
+    QByteArray k;
 
-    foreach (const TargetBase *t, _targets)
+    if (_route_cache)
+      {
+	k = route_key(key);
+
+	if (!k.isNull())
+	  {
+	    routes_t::const_iterator r = _newindex_routes.constFind(k);
+
+	    if (r != _newindex_routes.constEnd())
+	      {
+		const TargetBase *t = _targets[r.value()];
+
+		// entry may have been removed from the target since
+		if (t->_new_keys || t->_meta_contains(ls, key))
+		  return t->_meta_newindex(ls, key, value);
+
+		_newindex_routes.remove(k);
+	      }
+	  }
+      }
+
+    for (int i = 0; i < _targets.size(); i++)
       {
+	const TargetBase *t = _targets[i];
+
 	if ((t->_ops & Value::OpNewindex) && t->_support(Value::OpNewindex))
 	  {
 	    bool c = t->_meta_contains(ls, key);
@@ -78,6 +165,9 @@ namespace QtLua {
 		if (!c && shadow)
 		  throw String("Table write access to read only entry");
 
+		if (!k.isNull())
+		  add_route(_newindex_routes, k, i);
+
 		return t->_meta_newindex(ls, key, value);
 	      }
 	  }
@@ -104,6 +194,13 @@ namespace QtLua {
     return false;
   }
 
+  bool DispatchProxy::meta_find(State &ls, const Value &key, Value &value)
+  {
+    bool supported = false;
+
+    return find(ls, key, value, supported);
+  }
+
   Value::List DispatchProxy::meta_call(State &ls, const Value::List &args)
   {
     foreach (const TargetBase *t, _targets)
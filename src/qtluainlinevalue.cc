@@ -0,0 +1,412 @@
+
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <cstring>
+
+#include <QPoint>
+#include <QPointF>
+#include <QSize>
+#include <QSizeF>
+#include <QRect>
+#include <QRectF>
+#include <QColor>
+
+#include <QtLua/String>
+#include <QtLua/State>
+#include <QtLua/UserData>
+#include <QtLua/Value>
+
+#include <internal/InlineValue>
+
+namespace QtLua {
+
+  template <class X>
+  Value InlineValue<X>::new_value(State &ls, const X &value)
+  {
+    return Value(ls, QTLUA_REFNEW(InlineValue<X>, value));
+  }
+
+  template <class X>
+  bool InlineValue<X>::get(const Value &v, X &value)
+  {
+    if (v.type() != Value::TUserData)
+      return false;
+
+    Ref<UserData> ud = v.to_userdata_null();
+    InlineValue<X> *vt = dynamic_cast<InlineValue<X>*>(ud.ptr());
+
+    if (!vt)
+      return false;
+
+    value = vt->_value;
+    return true;
+  }
+
+  template <class X>
+  const typename InlineValue<X>::Field * InlineValue<X>::find_field(const Value &key)
+  {
+    if (key.type() != Value::TString)
+      return 0;
+
+    const char *name = key.to_cstring();
+
+    for (const Field *f = _fields; f->_name; f++)
+      if (!strcmp(f->_name, name))
+	return f;
+
+    return 0;
+  }
+
+  template <class X>
+  Value InlineValue<X>::meta_index(State &ls, const Value &key)
+  {
+    const Field *f = find_field(key);
+
+    if (!f)
+      throw String("No such field `%::%'").arg(_name).arg(key.to_string_p(false));
+
+    return Value(ls, f->_get(_value));
+  }
+
+  template <class X>
+  bool InlineValue<X>::meta_find(State &ls, const Value &key, Value &value)
+  {
+    const Field *f = find_field(key);
+
+    if (!f)
+      return false;
+
+    value = Value(ls, f->_get(_value));
+    return true;
+  }
+
+  template <class X>
+  void InlineValue<X>::meta_newindex(State &ls, const Value &key, const Value &value)
+  {
+    const Field *f = find_field(key);
+
+    if (!f)
+      throw String("No such field `%::%'").arg(_name).arg(key.to_string_p(false));
+
+    f->_set(_value, value.to_number());
+  }
+
+  template <class X>
+  String InlineValue<X>::get_type_name() const
+  {
+    return _name;
+  }
+
+  template <class X>
+  String InlineValue<X>::get_value_str() const
+  {
+    String res("{");
+
+    for (const Field *f = _fields; f->_name; f++)
+      {
+	if (f != _fields)
+	  res += ", ";
+	res += String("%=%").arg(f->_name)
+	  .arg(String(QByteArray::number(f->_get(_value))));
+      }
+
+    res += "}";
+    return res;
+  }
+
+  template <class X>
+  bool InlineValue<X>::operator==(const UserData &ud)
+  {
+    const InlineValue<X> *vt = dynamic_cast<const InlineValue<X>*>(&ud);
+
+    return vt && vt->_value == _value;
+  }
+
+  // arithmetic shared by points and sizes
+
+  template <class X>
+  static bool linear_op(State &ls, Value::Operation op, const Value &a,
+			const Value &b, Value &res)
+  {
+    X x, y;
+
+    switch (op)
+      {
+      case Value::OpAdd:
+	if (!InlineValue<X>::get(a, x) || !InlineValue<X>::get(b, y))
+	  return false;
+	res = InlineValue<X>::new_value(ls, x + y);
+	return true;
+
+      case Value::OpSub:
+	if (!InlineValue<X>::get(a, x) || !InlineValue<X>::get(b, y))
+	  return false;
+	res = InlineValue<X>::new_value(ls, x - y);
+	return true;
+
+      case Value::OpMul:
+	if (InlineValue<X>::get(a, x) && b.type() == Value::TNumber)
+	  res = InlineValue<X>::new_value(ls, x * b.to_number());
+	else if (a.type() == Value::TNumber && InlineValue<X>::get(b, x))
+	  res = InlineValue<X>::new_value(ls, x * a.to_number());
+	else
+	  return false;
+	return true;
+
+      case Value::OpDiv: {
+	if (!InlineValue<X>::get(a, x) || b.type() != Value::TNumber)
+	  return false;
+	double d = b.to_number();
+	if (d == 0)
+	  throw String("Division by zero");
+	res = InlineValue<X>::new_value(ls, x / d);
+	return true;
+      }
+
+      default:
+	return false;
+      }
+  }
+
+  template <class X>
+  static bool point_op(State &ls, Value::Operation op, const Value &a,
+		       const Value &b, Value &res)
+  {
+    X x;
+
+    if (op == Value::OpUnm && InlineValue<X>::get(a, x))
+      {
+	res = InlineValue<X>::new_value(ls, -x);
+	return true;
+      }
+
+    return linear_op<X>(ls, op, a, b, res);
+  }
+
+  // rectangles can be translated by a point
+  template <class X, class P>
+  static bool rect_op(State &ls, Value::Operation op, const Value &a,
+		      const Value &b, Value &res)
+  {
+    X x;
+    P p;
+
+    if (!InlineValue<X>::get(a, x) || !InlineValue<P>::get(b, p))
+      return false;
+
+    switch (op)
+      {
+      case Value::OpAdd:
+	res = InlineValue<X>::new_value(ls, x.translated(p));
+	return true;
+      case Value::OpSub:
+	res = InlineValue<X>::new_value(ls, x.translated(-p));
+	return true;
+      default:
+	return false;
+      }
+  }
+
+#define QTLUA_INLINEVALUE_FIELD(X, n, getter, setter, conv)	\
+  static qreal X##_get_##n(const X &x)				\
+  {								\
+    return x.getter();						\
+  }								\
+								\
+  static void X##_set_##n(X &x, qreal v)			\
+  {								\
+    x.setter(conv(v));						\
+  }
+
+#define QTLUA_INLINEVALUE_ENTRY(X, n)		\
+  { #n, X##_get_##n, X##_set_##n },
+
+#define QTLUA_INLINEVALUE_END			\
+  { 0, 0, 0 }
+
+  QTLUA_INLINEVALUE_FIELD(QPoint, x, x, setX, qRound)
+  QTLUA_INLINEVALUE_FIELD(QPoint, y, y, setY, qRound)
+
+  template <> const char InlineValue<QPoint>::_name[] = "QPoint";
+  template <> const InlineValue<QPoint>::Field InlineValue<QPoint>::_fields[] = {
+    QTLUA_INLINEVALUE_ENTRY(QPoint, x)
+    QTLUA_INLINEVALUE_ENTRY(QPoint, y)
+    QTLUA_INLINEVALUE_END
+  };
+
+  QTLUA_INLINEVALUE_FIELD(QPointF, x, x, setX, )
+  QTLUA_INLINEVALUE_FIELD(QPointF, y, y, setY, )
+
+  template <> const char InlineValue<QPointF>::_name[] = "QPointF";
+  template <> const InlineValue<QPointF>::Field InlineValue<QPointF>::_fields[] = {
+    QTLUA_INLINEVALUE_ENTRY(QPointF, x)
+    QTLUA_INLINEVALUE_ENTRY(QPointF, y)
+    QTLUA_INLINEVALUE_END
+  };
+
+  QTLUA_INLINEVALUE_FIELD(QSize, width, width, setWidth, qRound)
+  QTLUA_INLINEVALUE_FIELD(QSize, height, height, setHeight, qRound)
+
+  template <> const char InlineValue<QSize>::_name[] = "QSize";
+  template <> const InlineValue<QSize>::Field InlineValue<QSize>::_fields[] = {
+    QTLUA_INLINEVALUE_ENTRY(QSize, width)
+    QTLUA_INLINEVALUE_ENTRY(QSize, height)
+    QTLUA_INLINEVALUE_END
+  };
+
+  QTLUA_INLINEVALUE_FIELD(QSizeF, width, width, setWidth, )
+  QTLUA_INLINEVALUE_FIELD(QSizeF, height, height, setHeight, )
+
+  template <> const char InlineValue<QSizeF>::_name[] = "QSizeF";
+  template <> const InlineValue<QSizeF>::Field InlineValue<QSizeF>::_fields[] = {
+    QTLUA_INLINEVALUE_ENTRY(QSizeF, width)
+    QTLUA_INLINEVALUE_ENTRY(QSizeF, height)
+    QTLUA_INLINEVALUE_END
+  };
+
+  // moving x or y keeps the rectangle size
+  QTLUA_INLINEVALUE_FIELD(QRect, x, x, moveLeft, qRound)
+  QTLUA_INLINEVALUE_FIELD(QRect, y, y, moveTop, qRound)
+  QTLUA_INLINEVALUE_FIELD(QRect, width, width, setWidth, qRound)
+  QTLUA_INLINEVALUE_FIELD(QRect, height, height, setHeight, qRound)
+
+  template <> const char InlineValue<QRect>::_name[] = "QRect";
+  template <> const InlineValue<QRect>::Field InlineValue<QRect>::_fields[] = {
+    QTLUA_INLINEVALUE_ENTRY(QRect, x)
+    QTLUA_INLINEVALUE_ENTRY(QRect, y)
+    QTLUA_INLINEVALUE_ENTRY(QRect, width)
+    QTLUA_INLINEVALUE_ENTRY(QRect, height)
+    QTLUA_INLINEVALUE_END
+  };
+
+  QTLUA_INLINEVALUE_FIELD(QRectF, x, x, moveLeft, )
+  QTLUA_INLINEVALUE_FIELD(QRectF, y, y, moveTop, )
+  QTLUA_INLINEVALUE_FIELD(QRectF, width, width, setWidth, )
+  QTLUA_INLINEVALUE_FIELD(QRectF, height, height, setHeight, )
+
+  template <> const char InlineValue<QRectF>::_name[] = "QRectF";
+  template <> const InlineValue<QRectF>::Field InlineValue<QRectF>::_fields[] = {
+    QTLUA_INLINEVALUE_ENTRY(QRectF, x)
+    QTLUA_INLINEVALUE_ENTRY(QRectF, y)
+    QTLUA_INLINEVALUE_ENTRY(QRectF, width)
+    QTLUA_INLINEVALUE_ENTRY(QRectF, height)
+    QTLUA_INLINEVALUE_END
+  };
+
+  QTLUA_INLINEVALUE_FIELD(QColor, red, red, setRed, qRound)
+  QTLUA_INLINEVALUE_FIELD(QColor, green, green, setGreen, qRound)
+  QTLUA_INLINEVALUE_FIELD(QColor, blue, blue, setBlue, qRound)
+  QTLUA_INLINEVALUE_FIELD(QColor, alpha, alpha, setAlpha, qRound)
+
+  template <> const char InlineValue<QColor>::_name[] = "QColor";
+  template <> const InlineValue<QColor>::Field InlineValue<QColor>::_fields[] = {
+    QTLUA_INLINEVALUE_ENTRY(QColor, red)
+    QTLUA_INLINEVALUE_ENTRY(QColor, green)
+    QTLUA_INLINEVALUE_ENTRY(QColor, blue)
+    QTLUA_INLINEVALUE_ENTRY(QColor, alpha)
+    QTLUA_INLINEVALUE_END
+  };
+
+#undef QTLUA_INLINEVALUE_FIELD
+#undef QTLUA_INLINEVALUE_ENTRY
+#undef QTLUA_INLINEVALUE_END
+
+  // per type operators dispatch and support mask
+
+  template <class X>
+  static int value_ops()
+  {
+    return 0;
+  }
+
+  template <class X>
+  static bool value_op(State &ls, Value::Operation op, const Value &a,
+		       const Value &b, Value &res)
+  {
+    return false;
+  }
+
+#define QTLUA_INLINEVALUE_OPS(X, ops, call)				\
+  template <>								\
+  int value_ops<X>()							\
+  {									\
+    return ops;								\
+  }									\
+									\
+  template <>								\
+  bool value_op<X>(State &ls, Value::Operation op, const Value &a,	\
+		   const Value &b, Value &res)				\
+  {									\
+    return call(ls, op, a, b, res);					\
+  }
+
+#define QTLUA_INLINEVALUE_POINT_OPS					\
+  (Value::OpAdd | Value::OpSub | Value::OpMul | Value::OpDiv | Value::OpUnm)
+#define QTLUA_INLINEVALUE_SIZE_OPS					\
+  (Value::OpAdd | Value::OpSub | Value::OpMul | Value::OpDiv)
+#define QTLUA_INLINEVALUE_RECT_OPS					\
+  (Value::OpAdd | Value::OpSub)
+
+  QTLUA_INLINEVALUE_OPS(QPoint, QTLUA_INLINEVALUE_POINT_OPS, point_op<QPoint>)
+  QTLUA_INLINEVALUE_OPS(QPointF, QTLUA_INLINEVALUE_POINT_OPS, point_op<QPointF>)
+  QTLUA_INLINEVALUE_OPS(QSize, QTLUA_INLINEVALUE_SIZE_OPS, linear_op<QSize>)
+  QTLUA_INLINEVALUE_OPS(QSizeF, QTLUA_INLINEVALUE_SIZE_OPS, linear_op<QSizeF>)
+  QTLUA_INLINEVALUE_OPS(QRect, QTLUA_INLINEVALUE_RECT_OPS, (rect_op<QRect, QPoint>))
+  QTLUA_INLINEVALUE_OPS(QRectF, QTLUA_INLINEVALUE_RECT_OPS, (rect_op<QRectF, QPointF>))
+
+#undef QTLUA_INLINEVALUE_POINT_OPS
+#undef QTLUA_INLINEVALUE_SIZE_OPS
+#undef QTLUA_INLINEVALUE_RECT_OPS
+#undef QTLUA_INLINEVALUE_OPS
+
+  template <class X>
+  Value InlineValue<X>::meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    Value res(ls);
+
+    if (!value_op<X>(ls, op, a, b, res))
+      throw String("Operation not handled by % type with % and % operands")
+	.arg(_name).arg(a.type_name_u()).arg(b.type_name_u());
+
+    return res;
+  }
+
+  template <class X>
+  bool InlineValue<X>::support(Value::Operation c) const
+  {
+    int mask = value_ops<X>();
+
+    mask |= Value::OpIndex;
+    mask |= Value::OpNewindex;
+
+    return (mask & c) != 0;
+  }
+
+  template class InlineValue<QPoint>;
+  template class InlineValue<QPointF>;
+  template class InlineValue<QSize>;
+  template class InlineValue<QSizeF>;
+  template class InlineValue<QRect>;
+  template class InlineValue<QRectF>;
+  template class InlineValue<QColor>;
+
+}
+
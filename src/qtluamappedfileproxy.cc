@@ -0,0 +1,317 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2012, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <climits>
+#include <cstring>
+
+#include <QMetaType>
+
+#include <QtLua/MappedFileProxy>
+
+#include <internal/Member>
+
+namespace QtLua {
+
+  const ProxyMethod<MappedFileProxy>::Entry MappedFileProxy::_methods[] = {
+    { "slice", &MappedFileProxy::method_slice },
+    { 0, 0 }
+  };
+
+  MappedFileProxy::MappedFileProxy()
+    : _data(0),
+      _record_size(0),
+      _size(0),
+      _decoder(0)
+  {
+  }
+
+  MappedFileProxy::MappedFileProxy(const String &filename, int record_size, qint64 offset)
+    : _data(0),
+      _record_size(0),
+      _size(0),
+      _decoder(0)
+  {
+    open(filename, record_size, offset);
+  }
+
+  MappedFileProxy::~MappedFileProxy()
+  {
+    close();
+  }
+
+  void MappedFileProxy::open(const String &filename, int record_size, qint64 offset)
+  {
+    close();
+
+    if (record_size <= 0 || offset < 0)
+      throw String("Bad record size or offset for mapped file '%'.").arg(filename);
+
+    _file.setFileName(filename.to_qstring());
+
+    if (!_file.open(QIODevice::ReadOnly))
+      throw String("Unable to open file '%': %")
+	.arg(filename).arg(_file.errorString());
+
+    qint64 count = offset < _file.size() ? (_file.size() - offset) / record_size : 0;
+
+    if (count > INT_MAX)
+      count = INT_MAX;
+
+    if (count > 0)
+      {
+	// only whole records are mapped
+	_data = _file.map(offset, count * record_size);
+
+	if (!_data)
+	  {
+	    String e = String("Unable to map file '%': %")
+	      .arg(filename).arg(_file.errorString());
+	    _file.close();
+	    throw e;
+	  }
+      }
+
+    _record_size = record_size;
+    _size = count;
+  }
+
+  void MappedFileProxy::close()
+  {
+    if (_data)
+      _file.unmap(_data);
+
+    _file.close();
+    _data = 0;
+    _size = 0;
+  }
+
+  void MappedFileProxy::set_decoder(decoder_t decoder)
+  {
+    _decoder = decoder;
+  }
+
+  // field value is copied in this buffer before conversion
+  union field_buffer_t
+  {
+    double _d;
+    qint64 _i;
+    char _c[32];
+  };
+
+  void MappedFileProxy::add_field(const String &name, int offset, int type)
+  {
+    switch (type)
+      {
+      // plain value types which can be read from raw memory
+      case QMetaType::Bool:
+      case QMetaType::Int:
+      case QMetaType::UInt:
+      case QMetaType::Long:
+      case QMetaType::LongLong:
+      case QMetaType::Short:
+      case QMetaType::Char:
+      case QMetaType::ULong:
+      case QMetaType::ULongLong:
+      case QMetaType::UShort:
+      case QMetaType::UChar:
+      case QMetaType::Double:
+      case QMetaType::Float:
+      case QMetaType::QChar:
+      case QMetaType::QSize:
+      case QMetaType::QSizeF:
+      case QMetaType::QRect:
+      case QMetaType::QRectF:
+      case QMetaType::QPoint:
+      case QMetaType::QPointF:
+	break;
+
+      default:
+	// user types must be plain types too, this can not be checked
+	if (type >= QMetaType::User && QMetaType::isRegistered(type))
+	  break;
+
+	throw String("Type '%' can not be used for mapped file field '%'.")
+	  .arg(QMetaType::typeName(type) ? QMetaType::typeName(type) : "?").arg(name);
+      }
+
+    int size = QMetaType::sizeOf(type);
+
+    if (size <= 0 || size > (int)sizeof(field_buffer_t))
+      throw String("Type '%' of mapped file field '%' is too large.")
+	.arg(QMetaType::typeName(type)).arg(name);
+
+    if (offset < 0 || (_record_size && offset + size > _record_size))
+      throw String("Field '%' is outside of record.").arg(name);
+
+    Field f;
+
+    f._name = name;
+    f._offset = offset;
+    f._type = type;
+    f._size = size;
+
+    _fields.push_back(f);
+  }
+
+  Value MappedFileProxy::decode(State &ls, int index) const
+  {
+    const uchar *r = record(index);
+
+    if (_decoder)
+      return _decoder(ls, r, _record_size);
+
+    if (_fields.isEmpty())
+      return Value(ls, String((const char*)r, _record_size));
+
+    Value t(Value::new_table(ls, 0, _fields.size()));
+
+    foreach (const Field &f, _fields)
+      {
+	// fields may have been declared before file was opened
+	if (f._offset + f._size > _record_size)
+	  throw String("Field '%' is outside of record.").arg(f._name);
+
+	// mapped memory may not be suitably aligned for field type
+	field_buffer_t buf;
+
+	std::memcpy(&buf, r + f._offset, f._size);
+
+	Value v(Member::raw_get_object(ls, f._type, &buf));
+
+	if (f._name.isEmpty())
+	  return v;
+
+	t[f._name] = v;
+      }
+
+    return t;
+  }
+
+  Value MappedFileProxy::meta_index(State &ls, const Value &key)
+  {
+    if (key.type() == Value::TString)
+      {
+	Value m(ProxyMethod<MappedFileProxy>::get(ls, _methods, key));
+	if (!m.is_nil())
+	  meta_index_cache(ls, key, m);
+	return m;
+      }
+
+    unsigned int index = (unsigned int)key.to_number() - 1;
+
+    if (index < (unsigned int)_size)
+      return decode(ls, index);
+    else
+      return Value(ls);
+  }
+
+  bool MappedFileProxy::meta_contains(State &ls, const Value &key)
+  {
+    double n;
+
+    if (!key.try_to_number(n))
+      return false;
+
+    unsigned int index = (unsigned int)n - 1;
+
+    return index < (unsigned int)_size;
+  }
+
+  Value MappedFileProxy::meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    switch (op)
+      {
+      case Value::OpLen:
+	return Value(ls, _size);
+      default:
+	return UserData::meta_operation(ls, op, a, b);
+      }
+  }
+
+  bool MappedFileProxy::support(Value::Operation c) const
+  {
+    switch (c)
+      {
+      case Value::OpIndex:
+      case Value::OpIterate:
+      case Value::OpLen:
+	return true;
+      default:
+	return false;
+      }
+  }
+
+  String MappedFileProxy::get_type_name() const
+  {
+    return "QtLua::MappedFileProxy";
+  }
+
+  Value::List MappedFileProxy::method_slice(State &ls, const Value::List &args)
+  {
+    int first, last;
+    int count = ProxyMethodBase::get_range(args, 1, _size, first, last);
+
+    Value t(Value::new_table(ls, count));
+
+    for (int i = 0; i < count; i++)
+      t.raw_set(i + 1, decode(ls, first + i));
+
+    return t;
+  }
+
+  Ref<Iterator> MappedFileProxy::new_iterator(State &ls)
+  {
+    return QTLUA_REFNEW(ProxyIterator, &ls, *this);
+  }
+
+  MappedFileProxy::ProxyIterator::ProxyIterator(State *ls, const Ref<MappedFileProxy> &proxy)
+    : _ls(ls),
+      _proxy(proxy),
+      _it(0)
+  {
+  }
+
+  bool MappedFileProxy::ProxyIterator::more() const
+  {
+    return _it < _proxy->_size;
+  }
+
+  void MappedFileProxy::ProxyIterator::next()
+  {
+    _it++;
+  }
+
+  Value MappedFileProxy::ProxyIterator::get_key() const
+  {
+    return Value(_ls, _it + 1);
+  }
+
+  Value MappedFileProxy::ProxyIterator::get_value() const
+  {
+    return _proxy->decode(*_ls, _it);
+  }
+
+  ValueRef MappedFileProxy::ProxyIterator::get_value_ref()
+  {
+    return ValueRef(Value(_ls, _proxy), Value(_ls, (double)(_it + 1)));
+  }
+
+}
+
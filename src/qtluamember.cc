@@ -25,20 +25,32 @@
 #include <QRectF>
 #include <QPoint>
 #include <QPointF>
+#include <QColor>
 #include <QMetaObject>
 #include <QMetaType>
 #include <QWidget>
+#include <QVariant>
+#include <QSet>
+#include <QMutex>
+
+extern "C" {
+#include <lua.h>
+}
 
 #include <QtLua/String>
 #include <QtLua/MetaType>
+#include <QtLua/State>
+#include <QtLua/QListProxy>
+#include <QtLua/QHashProxy>
+#include <QtLua/ByteBuffer>
 #include <internal/QObjectWrapper>
+#include <internal/InlineValue>
+#include <internal/ContainerView>
 
 #include <internal/Member>
 
 namespace QtLua {
 
-  metatype_map_t types_map;
-
   void Member::assign(QObjectWrapper &obj, const Value &value)
   {
     throw String("Can not assign value to '%' member").arg(get_type_name());
@@ -65,241 +77,936 @@ namespace QtLua {
 
   static int ud_ref_type = qRegisterMetaType<Ref<UserData> >("Ref<UserData>");
 
-  Value Member::raw_get_object(State &ls, int type, const void *data)
+  Value Member::stack_value(State &ls, int index)
+  {
+    return Value(index, &ls);
+  }
+
+  void Member::stack_push(const Value &v)
+  {
+    v.push_value();
+  }
+
+  static inline int abs_index(lua_State *st, int i)
+  {
+    return i < 0 && i > LUA_REGISTRYINDEX ? lua_gettop(st) + i + 1 : i;
+  }
+
+  static void pull_error(lua_State *st, int i, int type)
+  {
+    throw String("Can not convert lua::% value to lua::%.")
+      .arg(lua_typename(st, lua_type(st, i))).arg(lua_typename(st, type));
+  }
+
+  static inline lua_Number pull_number(lua_State *st, int i)
+  {
+    if (!lua_isnumber(st, i) && lua_type(st, i) != LUA_TBOOLEAN)
+      pull_error(st, i, LUA_TNUMBER);
+
+    return lua_tonumber(st, i);
+  }
+
+  static inline String pull_string(lua_State *st, int i)
+  {
+    size_t len;
+    const char *s = lua_tolstring(st, i, &len);
+
+    if (!s)
+      pull_error(st, i, LUA_TSTRING);
+
+    return String(s, len);
+  }
+
+  static lua_Number pull_field(State &ls, lua_State *st, int i, int n)
   {
-    switch (type)
+    if (lua_type(st, i) != LUA_TTABLE)
+      return Member::stack_value(ls, i)[n].to_number();
+
+    lua_rawgeti(st, i, n);
+
+    if (!lua_isnumber(st, -1))
       {
-      case QMetaType::Void:
-	return Value(ls);
-      case QMetaType::Bool:
-	return Value(ls, (Value::Bool)*(bool*)data);
-      case QMetaType::Int:
-	return Value(ls, (double)*(int*)data);
-      case QMetaType::UInt:
-	return Value(ls, (double)*(unsigned int*)data);
-      case QMetaType::Long:
-	return Value(ls, (double)*(long*)data);
-      case QMetaType::LongLong:
-	return Value(ls, (double)*(long long*)data);
-      case QMetaType::Short:
-	return Value(ls, (double)*(short*)data);
-      case QMetaType::Char:
-	return Value(ls, (double)*(char*)data);
-      case QMetaType::ULong:
-	return Value(ls, (double)*(unsigned long*)data);
-      case QMetaType::ULongLong:
-	return Value(ls, (double)*(unsigned long long*)data);
-      case QMetaType::UShort:
-	return Value(ls, (double)*(unsigned short*)data);
-      case QMetaType::UChar:
-	return Value(ls, (double)*(unsigned char*)data);
-      case QMetaType::Double:
-	return Value(ls, *(double*)data);
-      case QMetaType::Float:
-	return Value(ls, *(float*)data);
-      case QMetaType::QChar:
-	return Value(ls, (double)reinterpret_cast<const QChar*>(data)->unicode());
-      case QMetaType::QString:
-	return Value(ls, String(*reinterpret_cast<const QString*>(data)));
-      case QMetaType::QStringList: {
-	Value value(ls, Value::TTable);
-	const QStringList *qsl = reinterpret_cast<const QStringList*>(data);
-	for (int i = 0; i < qsl->size(); i++)
-	  value[i+1] = String(qsl->at(i));
-	return value;
+	int t = lua_type(st, -1);
+	lua_pop(st, 1);
+	throw String("Can not convert lua::% value to lua::number.")
+	  .arg(lua_typename(st, t));
       }
-      case QMetaType::QByteArray:
-	return Value(ls, String(*reinterpret_cast<const QByteArray*>(data)));
-      case QMetaType::QObjectStar:
-	return Value(ls, QObjectWrapper::get_wrapper(ls, *(QObject**)data));
-      case QMetaType::QWidgetStar:
-	return Value(ls, QObjectWrapper::get_wrapper(ls, *(QWidget**)data));
-      case QMetaType::QSize: {
-	Value value(ls, Value::TTable);
-	const QSize *size = reinterpret_cast<const QSize*>(data);
-	value[1] = size->width();
-	value[2] = size->height();
-	return value;
-      }
-      case QMetaType::QSizeF: {
-	Value value(ls, Value::TTable);
-	const QSizeF *size = reinterpret_cast<const QSizeF*>(data);
-	value[1] = size->width();
-	value[2] = size->height();
-	return value;
-      }
-      case QMetaType::QRect: {
-	Value value(ls, Value::TTable);
-	const QRect *rect = reinterpret_cast<const QRect*>(data);
-	value[1] = rect->x();
-	value[2] = rect->y();
-	value[3] = rect->width();
-	value[4] = rect->height();
-	return value;
+
+    lua_Number res = lua_tonumber(st, -1);
+    lua_pop(st, 1);
+    return res;
+  }
+
+  static void push_fields(lua_State *st, const qreal *f, int count)
+  {
+    lua_createtable(st, count, 0);
+
+    for (int i = 0; i < count; i++)
+      {
+	lua_pushnumber(st, f[i]);
+	lua_rawseti(st, -2, i + 1);
       }
-      case QMetaType::QRectF: {
-	Value value(ls, Value::TTable);
-	const QRectF *rect = reinterpret_cast<const QRectF*>(data);
-	value[1] = rect->x();
-	value[2] = rect->y();
-	value[3] = rect->width();
-	value[4] = rect->height();
-	return value;
+  }
+
+#define QTLUA_CONV_NUMBER(name, type)					\
+  static void push_##name(State &ls, lua_State *st, const void *data)	\
+  {									\
+    lua_pushnumber(st, (lua_Number)*(const type*)data);			\
+  }									\
+									\
+  static void pull_##name(State &ls, lua_State *st, int i, void *data)	\
+  {									\
+    *(type*)data = (type)pull_number(st, i);				\
+  }
+
+  QTLUA_CONV_NUMBER(int, int)
+  QTLUA_CONV_NUMBER(uint, unsigned int)
+  QTLUA_CONV_NUMBER(long, long)
+  QTLUA_CONV_NUMBER(longlong, long long)
+  QTLUA_CONV_NUMBER(short, short)
+  QTLUA_CONV_NUMBER(char, char)
+  QTLUA_CONV_NUMBER(ulong, unsigned long)
+  QTLUA_CONV_NUMBER(ulonglong, unsigned long long)
+  QTLUA_CONV_NUMBER(ushort, unsigned short)
+  QTLUA_CONV_NUMBER(uchar, unsigned char)
+  QTLUA_CONV_NUMBER(double, double)
+  QTLUA_CONV_NUMBER(float, float)
+
+#undef QTLUA_CONV_NUMBER
+
+  static void push_void(State &ls, lua_State *st, const void *data)
+  {
+    lua_pushnil(st);
+  }
+
+  static void push_bool(State &ls, lua_State *st, const void *data)
+  {
+    lua_pushboolean(st, *(const bool*)data);
+  }
+
+  static void pull_bool(State &ls, lua_State *st, int i, void *data)
+  {
+    *(bool*)data = lua_toboolean(st, i);
+  }
+
+  static void push_qchar(State &ls, lua_State *st, const void *data)
+  {
+    lua_pushnumber(st, reinterpret_cast<const QChar*>(data)->unicode());
+  }
+
+  static void pull_qchar(State &ls, lua_State *st, int i, void *data)
+  {
+    *reinterpret_cast<QChar*>(data) = QChar((unsigned short)pull_number(st, i));
+  }
+
+  static void push_qstring(State &ls, lua_State *st, const void *data)
+  {
+    String s(*reinterpret_cast<const QString*>(data));
+    lua_pushlstring(st, s.constData(), s.size());
+  }
+
+  static void pull_qstring(State &ls, lua_State *st, int i, void *data)
+  {
+    *reinterpret_cast<QString*>(data) = pull_string(st, i).to_qstring();
+  }
+
+  static void push_qbytearray(State &ls, lua_State *st, const void *data)
+  {
+    const QByteArray *b = reinterpret_cast<const QByteArray*>(data);
+
+    if (ls.get_conversions() & State::ConvertByteBuffers)
+      Member::stack_push(Value(ls, QTLUA_REFNEW(ByteBuffer, *b)));
+    else
+      lua_pushlstring(st, b->constData(), b->size());
+  }
+
+  static void pull_qbytearray(State &ls, lua_State *st, int i, void *data)
+  {
+    QByteArray *b = reinterpret_cast<QByteArray*>(data);
+
+    // byte buffers are always accepted, data is shared
+    if (lua_type(st, i) == LUA_TUSERDATA &&
+	ByteBuffer::get(Member::stack_value(ls, i), *b))
+      return;
+
+    *b = pull_string(st, i);
+  }
+
+  // container views are used when enabled on the State object,
+  // they are always accepted back on conversion to Qt
+
+  template <class Container, class Proxy>
+  static inline bool push_view(State &ls, const void *data)
+  {
+    typedef ContainerView<Container, Proxy> view_t;
+
+    if (!(ls.get_conversions() & State::ConvertContainerViews))
+      return false;
+
+    Member::stack_push(Value(ls, QTLUA_REFNEW(view_t, *reinterpret_cast<const Container*>(data))));
+    return true;
+  }
+
+  template <class Container, class Proxy>
+  static inline bool pull_view(State &ls, lua_State *st, int i, void *data)
+  {
+    return lua_type(st, i) == LUA_TUSERDATA &&
+      ContainerView<Container, Proxy>::get(Member::stack_value(ls, i),
+					    *reinterpret_cast<Container*>(data));
+  }
+
+  static void push_qstringlist(State &ls, lua_State *st, const void *data)
+  {
+    if (push_view<QStringList, QListProxyRo<QStringList> >(ls, data))
+      return;
+
+    const QStringList *qsl = reinterpret_cast<const QStringList*>(data);
+
+    lua_createtable(st, qsl->size(), 0);
+
+    for (int i = 0; i < qsl->size(); i++)
+      {
+	String s(qsl->at(i));
+	lua_pushlstring(st, s.constData(), s.size());
+	lua_rawseti(st, -2, i + 1);
       }
-      case QMetaType::QPoint: {
-	Value value(ls, Value::TTable);
-	const QPoint *point = reinterpret_cast<const QPoint*>(data);
-	value[1] = point->x();
-	value[2] = point->y();
-	return value;
+  }
+
+  static void pull_qstringlist(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_view<QStringList, QListProxyRo<QStringList> >(ls, st, i, data))
+      return;
+
+    QStringList *qsl = reinterpret_cast<QStringList*>(data);
+
+    if (lua_type(st, i) == LUA_TTABLE)
+      {
+	for (int j = 1; ; j++)
+	  {
+	    lua_rawgeti(st, i, j);
+	    if (!lua_isstring(st, -1))
+	      {
+		lua_pop(st, 1);
+		break;
+	      }
+	    qsl->push_back(pull_string(st, -1).to_qstring());
+	    lua_pop(st, 1);
+	  }
       }
-      case QMetaType::QPointF: {
-	Value value(ls, Value::TTable);
-	const QPointF *point = reinterpret_cast<const QPointF*>(data);
-	value[1] = point->x();
-	value[2] = point->y();
-	return value;
+    else
+      {
+	Value v(Member::stack_value(ls, i));
+
+	if (v.support(Value::OpIndex))
+	  for (int j = 1; ; j++)
+	    {
+	      Value e(v[j]);
+	      if (e.type() != Value::TString && e.type() != Value::TNumber)
+		break;
+	      qsl->push_back(e.to_qstring());
+	    }
       }
-      default:
-	if (type == ud_ref_type)
-	  return Value(ls, **(Ref<UserData>*)data);
+  }
 
-	metatype_map_t::const_iterator i = types_map.find(type);
+  typedef QList<QObject*> qobject_list_t;
 
-	if (i != types_map.end())
-	  return i.value()->qt2lua(ls, data);
+  static void push_qobjectlist(State &ls, lua_State *st, const void *data)
+  {
+    if (push_view<qobject_list_t, QListProxyRo<qobject_list_t> >(ls, data))
+      return;
 
-	return Value(ls);
-      }
+    Member::stack_push(Value(ls, *reinterpret_cast<const qobject_list_t*>(data)));
   }
 
-  bool Member::raw_set_object(int type, void *data, const Value &v)
+  static void pull_qobjectlist(State &ls, lua_State *st, int i, void *data)
   {
-    switch (type)
+    if (pull_view<qobject_list_t, QListProxyRo<qobject_list_t> >(ls, st, i, data))
+      return;
+
+    qobject_list_t *list = reinterpret_cast<qobject_list_t*>(data);
+    Value v(Member::stack_value(ls, i));
+
+    for (int j = 1; ; j++)
       {
-      case QMetaType::Bool:
-	*(bool*)data = v.to_boolean();
-	return true;
-      case QMetaType::Int:
-	*(int*)data = v.to_number();
-	return true;
-      case QMetaType::UInt:
-	*(unsigned int*)data = v.to_number();
-	return true;
-      case QMetaType::Long:
-	*(long*)data = v.to_number();
-	return true;
-      case QMetaType::LongLong:
-	*(long long*)data = v.to_number();
-	return true;
-      case QMetaType::Short:
-	*(short*)data = v.to_number();
-	return true;
-      case QMetaType::Char:
-	*(char*)data = v.to_number();
-	return true;
-      case QMetaType::ULong:
-	*(unsigned long*)data = v.to_number();
-	return true;
-      case QMetaType::ULongLong:
-	*(unsigned long long*)data = v.to_number();
-	return true;
-      case QMetaType::UShort:
-	*(unsigned short*)data = v.to_number();
-	return true;
-      case QMetaType::UChar:
-	*(unsigned char*)data = v.to_number();
-	return true;
-      case QMetaType::Double:
-	*(double*)data = v.to_number();
-	return true;
-      case QMetaType::Float:
-	*(double*)data = v.to_number();
-	return true;
-      case QMetaType::QChar:
-	*reinterpret_cast<QChar*>(data) = QChar((unsigned short)v.to_number());
-	return true;
-      case QMetaType::QString:
-	*reinterpret_cast<QString*>(data) = v.to_qstring();
-	return true;
-      case QMetaType::QStringList: {
-	QStringList *qsl = reinterpret_cast<QStringList*>(data);
-	try {
-	  for (int i = 1; ; i++)
-	    qsl->push_back(v[i].to_qstring());
-	} catch (String &e) {
-	}
-	return true;
+	Value e(v[j]);
+	if (e.is_nil())
+	  break;
+	list->push_back(e.to_qobject());
       }
-      case QMetaType::QByteArray:
-	*reinterpret_cast<QByteArray*>(data) = v.to_string();
-	return true;
-      case QMetaType::QObjectStar:
-	*reinterpret_cast<QObject**>(data) = &v.to_userdata_cast<QObjectWrapper>()->get_object();
-	return true;
-      case QMetaType::QWidgetStar: {
-	QObject *obj = &v.to_userdata_cast<QObjectWrapper>()->get_object();
-	QWidget *w = qobject_cast<QWidget*>(obj);
-	if (!w)
-	  throw String("Can not convert lua value, QObject is not a QWidget.");
-	*reinterpret_cast<QWidget**>(data) = w;
-	return true;
+  }
+
+  static void push_qobject(State &ls, lua_State *st, const void *data)
+  {
+    Member::stack_push(Value(ls, QObjectWrapper::get_wrapper(ls, *(QObject* const*)data)));
+  }
+
+  static void pull_qobject(State &ls, lua_State *st, int i, void *data)
+  {
+    *reinterpret_cast<QObject**>(data) = &Member::stack_value(ls, i).to_userdata_cast<QObjectWrapper>()->get_object();
+  }
+
+  static void push_qwidget(State &ls, lua_State *st, const void *data)
+  {
+    Member::stack_push(Value(ls, QObjectWrapper::get_wrapper(ls, *(QWidget* const*)data)));
+  }
+
+  static void pull_qwidget(State &ls, lua_State *st, int i, void *data)
+  {
+    QObject *obj = &Member::stack_value(ls, i).to_userdata_cast<QObjectWrapper>()->get_object();
+    QWidget *w = qobject_cast<QWidget*>(obj);
+    if (!w)
+      throw String("Can not convert lua value, QObject is not a QWidget.");
+    *reinterpret_cast<QWidget**>(data) = w;
+  }
+
+  // inline value types are used when enabled on the State object,
+  // they are always accepted back on conversion to Qt
+
+  template <class X>
+  static inline bool push_inline(State &ls, const void *data)
+  {
+    if (!(ls.get_conversions() & State::ConvertValueTypes))
+      return false;
+
+    Member::stack_push(InlineValue<X>::new_value(ls, *reinterpret_cast<const X*>(data)));
+    return true;
+  }
+
+  template <class X>
+  static inline bool pull_inline(State &ls, lua_State *st, int i, void *data)
+  {
+    return lua_type(st, i) == LUA_TUSERDATA &&
+      InlineValue<X>::get(Member::stack_value(ls, i), *reinterpret_cast<X*>(data));
+  }
+
+  static void push_qsize(State &ls, lua_State *st, const void *data)
+  {
+    if (push_inline<QSize>(ls, data))
+      return;
+
+    const QSize *size = reinterpret_cast<const QSize*>(data);
+    qreal f[2] = { size->width(), size->height() };
+    push_fields(st, f, 2);
+  }
+
+  static void pull_qsize(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_inline<QSize>(ls, st, i, data))
+      return;
+
+    *reinterpret_cast<QSize*>(data) = QSize(pull_field(ls, st, i, 1),
+					    pull_field(ls, st, i, 2));
+  }
+
+  static void push_qsizef(State &ls, lua_State *st, const void *data)
+  {
+    if (push_inline<QSizeF>(ls, data))
+      return;
+
+    const QSizeF *size = reinterpret_cast<const QSizeF*>(data);
+    qreal f[2] = { size->width(), size->height() };
+    push_fields(st, f, 2);
+  }
+
+  static void pull_qsizef(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_inline<QSizeF>(ls, st, i, data))
+      return;
+
+    *reinterpret_cast<QSizeF*>(data) = QSizeF(pull_field(ls, st, i, 1),
+					      pull_field(ls, st, i, 2));
+  }
+
+  static void push_qrect(State &ls, lua_State *st, const void *data)
+  {
+    if (push_inline<QRect>(ls, data))
+      return;
+
+    const QRect *rect = reinterpret_cast<const QRect*>(data);
+    qreal f[4] = { rect->x(), rect->y(), rect->width(), rect->height() };
+    push_fields(st, f, 4);
+  }
+
+  static void pull_qrect(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_inline<QRect>(ls, st, i, data))
+      return;
+
+    *reinterpret_cast<QRect*>(data) = QRect(pull_field(ls, st, i, 1),
+					    pull_field(ls, st, i, 2),
+					    pull_field(ls, st, i, 3),
+					    pull_field(ls, st, i, 4));
+  }
+
+  static void push_qrectf(State &ls, lua_State *st, const void *data)
+  {
+    if (push_inline<QRectF>(ls, data))
+      return;
+
+    const QRectF *rect = reinterpret_cast<const QRectF*>(data);
+    qreal f[4] = { rect->x(), rect->y(), rect->width(), rect->height() };
+    push_fields(st, f, 4);
+  }
+
+  static void pull_qrectf(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_inline<QRectF>(ls, st, i, data))
+      return;
+
+    *reinterpret_cast<QRectF*>(data) = QRectF(pull_field(ls, st, i, 1),
+					      pull_field(ls, st, i, 2),
+					      pull_field(ls, st, i, 3),
+					      pull_field(ls, st, i, 4));
+  }
+
+  static void push_qpoint(State &ls, lua_State *st, const void *data)
+  {
+    if (push_inline<QPoint>(ls, data))
+      return;
+
+    const QPoint *point = reinterpret_cast<const QPoint*>(data);
+    qreal f[2] = { point->x(), point->y() };
+    push_fields(st, f, 2);
+  }
+
+  static void pull_qpoint(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_inline<QPoint>(ls, st, i, data))
+      return;
+
+    *reinterpret_cast<QPoint*>(data) = QPoint(pull_field(ls, st, i, 1),
+					      pull_field(ls, st, i, 2));
+  }
+
+  static void push_qpointf(State &ls, lua_State *st, const void *data)
+  {
+    if (push_inline<QPointF>(ls, data))
+      return;
+
+    const QPointF *point = reinterpret_cast<const QPointF*>(data);
+    qreal f[2] = { point->x(), point->y() };
+    push_fields(st, f, 2);
+  }
+
+  static void pull_qpointf(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_inline<QPointF>(ls, st, i, data))
+      return;
+
+    *reinterpret_cast<QPointF*>(data) = QPointF(pull_field(ls, st, i, 1),
+						pull_field(ls, st, i, 2));
+  }
+
+  static void push_qcolor(State &ls, lua_State *st, const void *data)
+  {
+    if (push_inline<QColor>(ls, data))
+      return;
+
+    const QColor *color = reinterpret_cast<const QColor*>(data);
+    qreal f[4] = { color->red(), color->green(), color->blue(), color->alpha() };
+    push_fields(st, f, 4);
+  }
+
+  static void pull_qcolor(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_inline<QColor>(ls, st, i, data))
+      return;
+
+    QColor *color = reinterpret_cast<QColor*>(data);
+
+    if (lua_type(st, i) == LUA_TSTRING)
+      {
+	*color = QColor(pull_string(st, i).to_qstring());
+	if (!color->isValid())
+	  throw String("Can not convert lua::string value to QColor, bad color name.");
+	return;
       }
-      case QMetaType::QSize: {
-	QSize *size = reinterpret_cast<QSize*>(data);
-	size->setWidth(v[1].to_number());
-	size->setHeight(v[2].to_number());
-	return true;
+
+    *color = QColor(pull_field(ls, st, i, 1), pull_field(ls, st, i, 2),
+		    pull_field(ls, st, i, 3));
+
+    if (lua_type(st, i) == LUA_TTABLE && lua_objlen(st, i) >= 4)
+      color->setAlpha(pull_field(ls, st, i, 4));
+  }
+
+  // QVariant and variant containers conversion. Lua tables are
+  // traversed directly on the stack, tables already on the current
+  // traversal path are reported as cycles. Entry points restore the
+  // stack top if an error is thrown during traversal.
+
+  typedef QSet<const void *> table_path_t;
+
+  static QVariant pull_variant_r(State &ls, lua_State *st, int i, table_path_t &path);
+
+  static void pull_enter(lua_State *st, int i, table_path_t &path)
+  {
+    if (!lua_checkstack(st, 3))
+      throw String("Lua table nesting is too deep for QVariant conversion.");
+
+    const void *t = lua_topointer(st, i);
+
+    if (path.contains(t))
+      throw String("Can not convert lua table with cycle to QVariant.");
+
+    path.insert(t);
+  }
+
+  static void pull_variantlist_r(State &ls, lua_State *st, int i, table_path_t &path,
+				 QVariantList &list)
+  {
+    if (lua_type(st, i) != LUA_TTABLE)
+      pull_error(st, i, LUA_TTABLE);
+
+    pull_enter(st, i, path);
+
+    int n = lua_objlen(st, i);
+    list.reserve(list.size() + n);
+
+    for (int j = 1; j <= n; j++)
+      {
+	lua_rawgeti(st, i, j);
+	list.append(pull_variant_r(ls, st, lua_gettop(st), path));
+	lua_pop(st, 1);
       }
-      case QMetaType::QSizeF: {
-	QSizeF *size = reinterpret_cast<QSizeF*>(data);
-	size->setWidth(v[1].to_number());
-	size->setHeight(v[2].to_number());
-	return true;
+
+    path.remove(lua_topointer(st, i));
+  }
+
+  template <class Container>
+  static void pull_variantmap_r(State &ls, lua_State *st, int i, table_path_t &path,
+				Container &map)
+  {
+    if (lua_type(st, i) != LUA_TTABLE)
+      pull_error(st, i, LUA_TTABLE);
+
+    pull_enter(st, i, path);
+
+    lua_pushnil(st);
+
+    while (lua_next(st, i))
+      {
+	QString key;
+
+	switch (lua_type(st, -2))
+	  {
+	  case LUA_TSTRING:
+	    key = pull_string(st, -2).to_qstring();
+	    break;
+	  case LUA_TNUMBER: {
+	    // do not use lua_tostring, it would change the key in place
+	    lua_Number n = lua_tonumber(st, -2);
+
+	    // default QString::number precision would merge large keys
+	    if (n >= -9e15 && n <= 9e15 && n == (lua_Number)(qlonglong)n)
+	      key = QString::number((qlonglong)n);
+	    else
+	      key = QString::number(n, 'g', 17);
+	    break;
+	  }
+	  default:
+	    throw String("Can not convert lua::% table key to QVariant map key.")
+	      .arg(lua_typename(st, lua_type(st, -2)));
+	  }
+
+	map.insert(key, pull_variant_r(ls, st, lua_gettop(st), path));
+	lua_pop(st, 1);
       }
-      case QMetaType::QRect: {
-	QRect *rect = reinterpret_cast<QRect*>(data);
-	rect->setX(v[1].to_number());
-	rect->setY(v[2].to_number());
-	rect->setWidth(v[3].to_number());
-	rect->setHeight(v[4].to_number());
-	return true;
+
+    path.remove(lua_topointer(st, i));
+  }
+
+  // lua tables with keys 1 to n only are converted to lists
+  static bool is_sequence(lua_State *st, int i)
+  {
+    size_t n = lua_objlen(st, i);
+    size_t count = 0;
+
+    lua_pushnil(st);
+
+    while (lua_next(st, i))
+      {
+	lua_pop(st, 1);
+	if (++count > n)
+	  {
+	    lua_pop(st, 1);
+	    return false;
+	  }
       }
-      case QMetaType::QRectF: {
-	QRectF *rect = reinterpret_cast<QRectF*>(data);
-	rect->setX(v[1].to_number());
-	rect->setY(v[2].to_number());
-	rect->setWidth(v[3].to_number());
-	rect->setHeight(v[4].to_number());
-	return true;
+
+    return true;
+  }
+
+  template <class X>
+  static inline bool variant_inline(const Value &v, QVariant &res)
+  {
+    X x;
+
+    if (!InlineValue<X>::get(v, x))
+      return false;
+
+    res = QVariant(x);
+    return true;
+  }
+
+  template <class Container, class Proxy>
+  static inline bool variant_view(const Value &v, int type, QVariant &res)
+  {
+    Container c;
+
+    if (!ContainerView<Container, Proxy>::get(v, c))
+      return false;
+
+    res = QVariant(type, &c);
+    return true;
+  }
+
+  static QVariant pull_variant_ud(State &ls, lua_State *st, int i)
+  {
+    Value v(Member::stack_value(ls, i));
+    Ref<UserData> ud = v.to_userdata_null();
+    QVariant res;
+
+    if (!ud.valid())
+      pull_error(st, i, LUA_TUSERDATA);
+
+    if (QObjectWrapper *qow = dynamic_cast<QObjectWrapper*>(ud.ptr()))
+      return QVariant::fromValue(&qow->get_object());
+
+    if (variant_inline<QRect>(v, res) ||
+	variant_inline<QRectF>(v, res) ||
+	variant_inline<QPoint>(v, res) ||
+	variant_inline<QPointF>(v, res) ||
+	variant_inline<QSize>(v, res) ||
+	variant_inline<QSizeF>(v, res) ||
+	variant_inline<QColor>(v, res) ||
+	variant_view<QStringList, QListProxyRo<QStringList> >(v, QMetaType::QStringList, res) ||
+	variant_view<QVariantList, QListProxyRo<QVariantList> >(v, QMetaType::QVariantList, res) ||
+	variant_view<QVariantMap, QHashProxyRo<QVariantMap> >(v, QMetaType::QVariantMap, res))
+      return res;
+
+    return QVariant(ud_ref_type, &ud);
+  }
+
+  static QVariant pull_variant_r(State &ls, lua_State *st, int i, table_path_t &path)
+  {
+    switch (lua_type(st, i))
+      {
+      case LUA_TNONE:
+      case LUA_TNIL:
+	return QVariant();
+
+      case LUA_TBOOLEAN:
+	return QVariant((bool)lua_toboolean(st, i));
+
+      case LUA_TNUMBER:
+	return QVariant((double)lua_tonumber(st, i));
+
+      case LUA_TSTRING:
+	return QVariant(QByteArray(pull_string(st, i)));
+
+      case LUA_TTABLE:
+	if (is_sequence(st, i))
+	  {
+	    QVariantList list;
+	    pull_variantlist_r(ls, st, i, path, list);
+	    return list;
+	  }
+	else
+	  {
+	    QVariantMap map;
+	    pull_variantmap_r(ls, st, i, path, map);
+	    return map;
+	  }
+
+      case LUA_TUSERDATA:
+	return pull_variant_ud(ls, st, i);
+
+      default:
+	throw String("Can not convert lua::% value to QVariant.")
+	  .arg(lua_typename(st, lua_type(st, i)));
       }
-      case QMetaType::QPoint: {
-	QPoint *point = reinterpret_cast<QPoint*>(data);
-	point->setX(v[1].to_number());
-	point->setY(v[2].to_number());
-	return true;
+  }
+
+  static void push_qvariant(State &ls, lua_State *st, const void *data)
+  {
+    const QVariant *v = reinterpret_cast<const QVariant*>(data);
+
+    if (!lua_checkstack(st, 3))
+      throw String("QVariant nesting is too deep for lua conversion.");
+
+    Member::raw_push(ls, v->userType(), v->constData());
+  }
+
+  static void pull_qvariant(State &ls, lua_State *st, int i, void *data)
+  {
+    table_path_t path;
+    int top = lua_gettop(st);
+
+    try {
+      *reinterpret_cast<QVariant*>(data) = pull_variant_r(ls, st, i, path);
+    } catch (...) {
+      lua_settop(st, top);
+      throw;
+    }
+  }
+
+  static void push_qvariantlist(State &ls, lua_State *st, const void *data)
+  {
+    if (push_view<QVariantList, QListProxyRo<QVariantList> >(ls, data))
+      return;
+
+    const QVariantList *list = reinterpret_cast<const QVariantList*>(data);
+
+    lua_createtable(st, list->size(), 0);
+
+    for (int i = 0; i < list->size(); i++)
+      {
+	push_qvariant(ls, st, &list->at(i));
+	lua_rawseti(st, -2, i + 1);
       }
-      case QMetaType::QPointF: {
-	QPointF *point = reinterpret_cast<QPointF*>(data);
-	point->setX(v[1].to_number());
-	point->setY(v[2].to_number());
-	return true;
+  }
+
+  static void pull_qvariantlist(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_view<QVariantList, QListProxyRo<QVariantList> >(ls, st, i, data))
+      return;
+
+    table_path_t path;
+    int top = lua_gettop(st);
+
+    try {
+      pull_variantlist_r(ls, st, i, path, *reinterpret_cast<QVariantList*>(data));
+    } catch (...) {
+      lua_settop(st, top);
+      throw;
+    }
+  }
+
+  template <class Container>
+  static void push_variantmap(State &ls, lua_State *st, const Container &map)
+  {
+    lua_createtable(st, 0, map.size());
+
+    for (typename Container::const_iterator j = map.constBegin(); j != map.constEnd(); j++)
+      {
+	String key(j.key());
+	lua_pushlstring(st, key.constData(), key.size());
+	push_qvariant(ls, st, &j.value());
+	lua_rawset(st, -3);
       }
-      default:
-	if (type == ud_ref_type)
+  }
+
+  static void push_qvariantmap(State &ls, lua_State *st, const void *data)
+  {
+    if (push_view<QVariantMap, QHashProxyRo<QVariantMap> >(ls, data))
+      return;
+
+    push_variantmap(ls, st, *reinterpret_cast<const QVariantMap*>(data));
+  }
+
+  static void pull_qvariantmap(State &ls, lua_State *st, int i, void *data)
+  {
+    if (pull_view<QVariantMap, QHashProxyRo<QVariantMap> >(ls, st, i, data))
+      return;
+
+    table_path_t path;
+    int top = lua_gettop(st);
+
+    try {
+      pull_variantmap_r(ls, st, i, path, *reinterpret_cast<QVariantMap*>(data));
+    } catch (...) {
+      lua_settop(st, top);
+      throw;
+    }
+  }
+
+  static void push_qvarianthash(State &ls, lua_State *st, const void *data)
+  {
+    push_variantmap(ls, st, *reinterpret_cast<const QVariantHash*>(data));
+  }
+
+  static void pull_qvarianthash(State &ls, lua_State *st, int i, void *data)
+  {
+    table_path_t path;
+    int top = lua_gettop(st);
+
+    try {
+      pull_variantmap_r(ls, st, i, path, *reinterpret_cast<QVariantHash*>(data));
+    } catch (...) {
+      lua_settop(st, top);
+      throw;
+    }
+  }
+
+  static void push_udref(State &ls, lua_State *st, const void *data)
+  {
+    Member::stack_push(Value(ls, *reinterpret_cast<const Ref<UserData>*>(data)));
+  }
+
+  static void pull_udref(State &ls, lua_State *st, int i, void *data)
+  {
+    *reinterpret_cast<Ref<UserData>*>(data) = Member::stack_value(ls, i).to_userdata();
+  }
+
+  Member::converters_t Member::build_converters()
+  {
+    converters_t table(QMetaType::User);
+
+#define QTLUA_CONV_SET(type, push, pull)	\
+    if (table.size() <= (int)(type))		\
+      table.resize((type) + 1);			\
+    table[type]._push = push;			\
+    table[type]._pull = pull;
+
+    QTLUA_CONV_SET(QMetaType::Void, push_void, 0);
+    QTLUA_CONV_SET(QMetaType::Bool, push_bool, pull_bool);
+    QTLUA_CONV_SET(QMetaType::Int, push_int, pull_int);
+    QTLUA_CONV_SET(QMetaType::UInt, push_uint, pull_uint);
+    QTLUA_CONV_SET(QMetaType::Long, push_long, pull_long);
+    QTLUA_CONV_SET(QMetaType::LongLong, push_longlong, pull_longlong);
+    QTLUA_CONV_SET(QMetaType::Short, push_short, pull_short);
+    QTLUA_CONV_SET(QMetaType::Char, push_char, pull_char);
+    QTLUA_CONV_SET(QMetaType::ULong, push_ulong, pull_ulong);
+    QTLUA_CONV_SET(QMetaType::ULongLong, push_ulonglong, pull_ulonglong);
+    QTLUA_CONV_SET(QMetaType::UShort, push_ushort, pull_ushort);
+    QTLUA_CONV_SET(QMetaType::UChar, push_uchar, pull_uchar);
+    QTLUA_CONV_SET(QMetaType::Double, push_double, pull_double);
+    QTLUA_CONV_SET(QMetaType::Float, push_float, pull_float);
+    QTLUA_CONV_SET(QMetaType::QChar, push_qchar, pull_qchar);
+    QTLUA_CONV_SET(QMetaType::QString, push_qstring, pull_qstring);
+    QTLUA_CONV_SET(QMetaType::QStringList, push_qstringlist, pull_qstringlist);
+    QTLUA_CONV_SET(QMetaType::QByteArray, push_qbytearray, pull_qbytearray);
+    QTLUA_CONV_SET(QMetaType::QVariant, push_qvariant, pull_qvariant);
+    QTLUA_CONV_SET(QMetaType::QVariantList, push_qvariantlist, pull_qvariantlist);
+    QTLUA_CONV_SET(QMetaType::QVariantMap, push_qvariantmap, pull_qvariantmap);
+    QTLUA_CONV_SET(QMetaType::QVariantHash, push_qvarianthash, pull_qvarianthash);
+    QTLUA_CONV_SET(QMetaType::QObjectStar, push_qobject, pull_qobject);
+    QTLUA_CONV_SET(QMetaType::QWidgetStar, push_qwidget, pull_qwidget);
+    QTLUA_CONV_SET(QMetaType::QSize, push_qsize, pull_qsize);
+    QTLUA_CONV_SET(QMetaType::QSizeF, push_qsizef, pull_qsizef);
+    QTLUA_CONV_SET(QMetaType::QRect, push_qrect, pull_qrect);
+    QTLUA_CONV_SET(QMetaType::QRectF, push_qrectf, pull_qrectf);
+    QTLUA_CONV_SET(QMetaType::QPoint, push_qpoint, pull_qpoint);
+    QTLUA_CONV_SET(QMetaType::QPointF, push_qpointf, pull_qpointf);
+    QTLUA_CONV_SET(QMetaType::QColor, push_qcolor, pull_qcolor);
+    // may run before ud_ref_type static initialization
+    int ud_ref = qRegisterMetaType<Ref<UserData> >("Ref<UserData>");
+    QTLUA_CONV_SET(ud_ref, push_udref, pull_udref);
+    int qobject_list = qRegisterMetaType<qobject_list_t>("QList<QObject*>");
+    QTLUA_CONV_SET(qobject_list, push_qobjectlist, pull_qobjectlist);
+
+#undef QTLUA_CONV_SET
+
+    return table;
+  }
+
+  Member::converters_t & Member::converters()
+  {
+    static converters_t table(build_converters());
+    return table;
+  }
+
+  static QMutex metatype_lock;
+
+  void metatype_register(int type, metatype_void_t *mt)
+  {
+    QMutexLocker lock(&metatype_lock);
+    Member::converters_t &table = Member::converters();
+
+    if (type < table.size() && table[type]._meta)
+      throw String("Lua conversion handler already registered for type %").arg(type);
+
+    if (table.size() <= type)
+      table.resize(type + 1);
+
+    table[type]._meta = mt;
+  }
+
+  void metatype_unregister(int type)
+  {
+    QMutexLocker lock(&metatype_lock);
+    Member::converters_t &table = Member::converters();
+
+    if (type < table.size())
+      table[type]._meta = 0;
+  }
+
+  bool Member::raw_push(State &ls, int type, const void *data)
+  {
+    lua_State *st = ls._lst;
+    const converters_t &table = converters();
+
+    if (type >= 0 && type < table.size())
+      {
+	const Converter &c = table[type];
+
+	// user handlers take precedence over built-in conversions
+	if (c._meta)
 	  {
-	    *reinterpret_cast<Ref<UserData>*>(data) = v.to_userdata();
+	    c._meta->qt2lua(ls, data).push_value();
 	    return true;
 	  }
 
-	metatype_map_t::const_iterator i = types_map.find(type);
+	if (c._push)
+	  {
+	    c._push(ls, st, data);
+	    return true;
+	  }
+      }
 
-	if (i != types_map.end())
-	  return i.value()->lua2qt(data, v);
+    lua_pushnil(st);
+    return false;
+  }
+
+  bool Member::raw_pull(State &ls, int index, int type, void *data)
+  {
+    lua_State *st = ls._lst;
+    const converters_t &table = converters();
+
+    if (type < 0 || type >= table.size())
+      return false;
+
+    const Converter &c = table[type];
 
-	return false;
+    if (c._meta)
+      return c._meta->lua2qt(data, Value(index, &ls));
+
+    if (c._pull)
+      {
+	c._pull(ls, st, abs_index(st, index), data);
+	return true;
       }
 
+    return false;
   }
+
+  Value Member::raw_get_object(State &ls, int type, const void *data)
+  {
+    raw_push(ls, type, data);
+
+    Value res(-1, &ls);
+    lua_pop(ls._lst, 1);
+    return res;
+  }
+
+  bool Member::raw_set_object(int type, void *data, const Value &v)
+  {
+    State &ls = *v._st;
+    lua_State *st = ls._lst;
+    bool res;
+
+    v.push_value();
+
+    try {
+      res = raw_pull(ls, -1, type, data);
+    } catch (...) {
+      lua_pop(st, 1);
+      throw;
+    }
+
+    lua_pop(st, 1);
+    return res;
+  }
+
 }
 
@@ -18,10 +18,13 @@
 
 */
 
+#include <algorithm>
+
 #include <QDebug>
 #include <QObject>
 #include <QMetaObject>
 #include <QWidget>
+#include <QTimerEvent>
 
 #include <internal/QObjectWrapper>
 
@@ -29,6 +32,7 @@
 #include <internal/Method>
 #include <internal/MetaCache>
 #include <internal/QObjectIterator>
+#include <internal/SignalQueue>
 
 #define assert_do(x) { bool res_ = (x); assert (((void)#x, res_)); }
 
@@ -93,6 +97,12 @@ namespace QtLua {
 #endif
     assert(_obj = sender());
 
+    // Qt drops connections of the destroyed object, relay entries
+    // must be removed as well
+    lua_slots_hash_t::iterator i;
+    for (i = _lua_slots.begin(); i != _lua_slots.end(); ++i)
+      lua_slot_unrelay(i.value());
+
     assert_do(_ls._whash.remove(_obj));
     _obj = 0;
     _drop();
@@ -148,54 +158,253 @@ namespace QtLua {
 
     lua_slots_hash_t::iterator i = _lua_slots.find(id);
     assert(i != _lua_slots.end());
+    LuaSlot &slot = i.value();
+
+    if (slot._flags & Value::ConnectCoalesce)
+      {
+	// signal arguments are only valid during emission, keep a copy
+	// of latest ones until the lua value actually gets called
+	slot._args.resize(slot._types.size());
+	for (int j = 0; j < slot._types.size(); j++)
+	  slot._args[j] = QVariant(slot._types[j], qt_args[j + 1]);
+
+	lua_slot_coalesce(id, slot);
+	return -1;
+      }
 
     Value::List lua_args;
 
     // first arg is sender object
-    if (_obj)
-      {
-	assert(_obj == sender());
-	lua_args.push_back(Value(_ls, QObjectWrapper::get_wrapper(_ls, _obj)));
-      }
-    else
-      lua_args.push_back(Value(_ls));
+    assert(!_obj || _obj == sender());
+    lua_args.push_back(lua_sender());
 
     // push more args from parameter type informations
-    QMetaMethod mm = _obj->metaObject()->method(i.value()._sigindex);
+    for (int j = 0; j < slot._types.size(); j++)
+      lua_args.push_back(Member::raw_get_object(_ls, slot._types[j], qt_args[j + 1]));
 
-    foreach(const QByteArray &pt, mm.parameterTypes())
-      {
-	qt_args++;
-	lua_args.push_back(Member::raw_get_object(_ls, QMetaType::type(pt.constData()), *qt_args));
-      }
+    lua_slot_call(slot._value, lua_args);
+
+    return -1;
+  }
 
+  Value QObjectWrapper::lua_sender() const
+  {
+    if (_obj)
+      return Value(_ls, QObjectWrapper::get_wrapper(_ls, _obj));
+    else
+      return Value(_ls);
+  }
+
+  void QObjectWrapper::lua_slot_call(const Value &value, const Value::List &args)
+  {
     try {
-      i.value()._value.call(lua_args);
+      value.call(args);
     } catch (const String &err) {
       qDebug() << "Error executing lua slot:" << err;
     }
+  }
 
-    return -1;
+  void QObjectWrapper::lua_slot_call(const Value &value, const QVariant *args, int count)
+  {
+    Value::List lua_args;
+
+    lua_args.push_back(lua_sender());
+
+    for (int j = 0; j < count; j++)
+      lua_args.push_back(Member::raw_get_object(_ls, args[j].userType(), args[j].constData()));
+
+    lua_slot_call(value, lua_args);
+  }
+
+  void QObjectWrapper::lua_slot_coalesce(int slot_id, LuaSlot &slot)
+  {
+    if (slot._timer)
+      return;
+
+    int delay = 0;
+
+    if (slot._interval && slot._last.isValid())
+      delay = (int)std::max<qint64>(0, slot._interval - slot._last.elapsed());
+
+    slot._timer = startTimer(delay);
+    _lua_timers.insert(slot._timer, slot_id);
+  }
+
+  void QObjectWrapper::lua_slot_cancel(LuaSlot &slot)
+  {
+    if (!slot._timer)
+      return;
+
+    killTimer(slot._timer);
+    _lua_timers.remove(slot._timer);
+    slot._timer = 0;
+  }
+
+  void QObjectWrapper::timerEvent(QTimerEvent *event)
+  {
+    int timer = event->timerId();
+
+    killTimer(timer);
+
+    lua_slots_hash_t::iterator i = _lua_slots.find(_lua_timers.take(timer));
+
+    if (i == _lua_slots.end() || i.value()._timer != timer)
+      return;
+
+    LuaSlot &slot = i.value();
+    slot._timer = 0;
+    slot._last.start();
+
+    QVector<QVariant> args(slot._args);
+    slot._args.clear();
+
+    // sender has been destroyed meanwhile, arguments may be stale
+    if (!_obj)
+      return;
+
+    // slot may be disconnected by the call
+    Value value(slot._value);
+    lua_slot_call(value, args.constData(), args.size());
   }
 
-  void QObjectWrapper::_lua_connect(int sigindex, const Value &value)
+  void QObjectWrapper::lua_slot_unrelay(LuaSlot &slot)
   {
+    if (slot._relay_id < 0)
+      return;
+
+    SignalRelay::instance().remove(slot._relay_id);
+    slot._relay_id = -1;
+  }
+
+  void QObjectWrapper::lua_slot_disconnect(int slot_id, LuaSlot &slot)
+  {
+    lua_slot_cancel(slot);
+
+    if (slot._relay_id < 0)
+      {
+	bool ok = QMetaObject::disconnect(_obj, slot._sigindex, this, metaObject()->methodCount() + slot_id);
+	assert(ok);
+	return;
+      }
+
+    SignalRelay &relay = SignalRelay::instance();
+    bool ok = QMetaObject::disconnect(_obj, slot._sigindex, &relay, relay.method_index(slot._relay_id));
+    assert(ok);
+    lua_slot_unrelay(slot);
+  }
+
+  void QObjectWrapper::lua_slot_dequeue(SignalQueue::Node *n)
+  {
+    lua_slots_hash_t::iterator i = _lua_slots.find(n->_slot_id);
+
+    // slot has been disconnected since signal emission
+    if (i == _lua_slots.end() || i.value()._serial != n->_serial)
+      return;
+
+    LuaSlot &slot = i.value();
+
+    if (slot._flags & Value::ConnectCoalesce)
+      {
+	slot._args.resize(n->_args.size());
+	for (int j = 0; j < n->_args.size(); j++)
+	  slot._args[j] = n->_args[j];
+
+	lua_slot_coalesce(n->_slot_id, slot);
+	return;
+      }
+
+    Value value(slot._value);
+    lua_slot_call(value, n->_args.constData(), n->_args.size());
+  }
+
+  void QObjectWrapper::_lua_queue_drain(State &ls)
+  {
+    SignalQueue &queue = *ls._signal_queue;
+
+    queue.drain_begin();
+
+    // limit batch size to keep the event loop responsive
+    for (int count = 0; count < 1024; count++)
+      {
+	SignalQueue::Node *n = queue.pop();
+
+	if (!n)
+	  return;
+
+	wrapper_hash_t::iterator w = ls._whash.find(n->_sender);
+
+	// wrapper may have been destroyed along with its connections
+	if (w != ls._whash.end())
+	  w.value()->lua_slot_dequeue(n);
+
+	queue.release(n);
+      }
+
+    queue.release_flush();
+    queue.drain_defer();
+  }
+
+  void QObjectWrapper::_lua_connect(int sigindex, const Value &value,
+				   Value::ConnectFlags flags, unsigned int max_rate)
+  {
+    static QAtomicInt serial;
+
     switch (value.type())
       {
       case Value::TUserData:
       case Value::TFunction: {
-	int slot_id;
+	int slot_id = _lua_free_slots.empty()
+	  ? _lua_next_slot++ : _lua_free_slots.takeLast();
 
-	do {
-	  slot_id = _lua_next_slot++;
-	} while (_lua_slots.contains(slot_id));
+	int interval = 0;
 
-	if (QMetaObject::connect(_obj, sigindex, this, metaObject()->methodCount() + slot_id))
+	if (max_rate)
 	  {
-	    _lua_slots.insert(slot_id, LuaSlot(value, sigindex));
+	    flags |= Value::ConnectCoalesce;
+	    interval = (1000 + max_rate - 1) / max_rate;
+	  }
+
+	QVector<int> types;
+
+	foreach(const QByteArray &pt, _obj->metaObject()->method(sigindex).parameterTypes())
+	  types.push_back(QMetaType::type(pt.constData()));
+
+	LuaSlot slot(value, sigindex, types, flags, interval);
+	slot._serial = serial.fetchAndAddRelaxed(1);
+
+	bool ok;
+
+	if (flags & Value::ConnectQueued)
+	  {
+	    // queued connections are handled by the emitting thread
+	    // through the relay object which outlives any emission
+	    SignalRelay &relay = SignalRelay::instance();
+	    SignalRelay::Entry e;
+
+	    e._queue = _ls._signal_queue;
+	    e._sender = _obj;
+	    e._slot_id = slot_id;
+	    e._serial = slot._serial;
+	    e._types = types;
+
+	    slot._relay_id = relay.add(e);
+	    ok = QMetaObject::connect(_obj, sigindex, &relay, relay.method_index(slot._relay_id),
+				      Qt::DirectConnection);
+	  }
+	else
+	  {
+	    ok = QMetaObject::connect(_obj, sigindex, this, metaObject()->methodCount() + slot_id);
+	  }
+
+	if (ok)
+	  {
+	    _lua_signals[sigindex].insert(value.to_pointer(), slot_id);
+	    _lua_slots.insert(slot_id, slot);
 	    return;
 	  }
 
+	lua_slot_unrelay(slot);
+	_lua_free_slots.push_back(slot_id);
 	throw String("Unable to connect Qt signal.");
       }
 
@@ -204,56 +413,55 @@ namespace QtLua {
       }
   }
 
+  void QObjectWrapper::lua_slot_remove(int slot_id)
+  {
+    lua_slots_hash_t::iterator i = _lua_slots.find(slot_id);
+    assert(i != _lua_slots.end());
+
+    lua_slot_disconnect(slot_id, i.value());
+    _lua_slots.erase(i);
+    _lua_free_slots.push_back(slot_id);
+  }
+
   bool QObjectWrapper::_lua_disconnect(int sigindex, const Value &value)
   {
-    lua_slots_hash_t::iterator i;
+    lua_signals_hash_t::iterator s = _lua_signals.find(sigindex);
 
-    for (i = _lua_slots.begin(); i != _lua_slots.end(); )
-      {
-	if (i.value()._sigindex == sigindex && value == i.value()._value)
-	  {
-	    bool ok = QMetaObject::disconnect(_obj, sigindex, this, metaObject()->methodCount() + i.key());
-	    assert(ok);
-	    _lua_next_slot = std::min(_lua_next_slot, i.key());
-	    i = _lua_slots.erase(i);
-	    return true;
-	  }
-	else
-	  ++i;
-      }
+    if (s == _lua_signals.end())
+      return false;
+
+    lua_slots_index_t::iterator i = s.value().find(value.to_pointer());
 
-    return false;
+    if (i == s.value().end())
+      return false;
+
+    int slot_id = i.value();
+
+    s.value().erase(i);
+    if (s.value().empty())
+      _lua_signals.erase(s);
+
+    lua_slot_remove(slot_id);
+    return true;
   }
 
   void QObjectWrapper::_lua_disconnect_all(int sigindex)
   {
-    lua_slots_hash_t::iterator i;
-
-    for (i = _lua_slots.begin(); i != _lua_slots.end(); )
-      {
-	if (i.value()._sigindex == sigindex)
-	  {
-	    bool ok = QMetaObject::disconnect(_obj, sigindex, this, metaObject()->methodCount() + i.key());
-	    assert(ok);
-	    _lua_next_slot = std::min(_lua_next_slot, i.key());
-	    i = _lua_slots.erase(i);
-	  }
-	else
-	  ++i;
-      }
+    foreach(int slot_id, _lua_signals.take(sigindex))
+      lua_slot_remove(slot_id);
   }
 
   void QObjectWrapper::_lua_disconnect_all()
   {
     lua_slots_hash_t::iterator i;
 
-    for (i = _lua_slots.begin(); i != _lua_slots.end(); )
-      {
-	bool ok = QMetaObject::disconnect(_obj, i.value()._sigindex, this, metaObject()->methodCount() + i.key());
-	assert(ok);
-	++i;
-      }
+    for (i = _lua_slots.begin(); i != _lua_slots.end(); ++i)
+      lua_slot_disconnect(i.key(), i.value());
+
     _lua_slots.clear();
+
+    _lua_signals.clear();
+    _lua_free_slots.clear();
     _lua_next_slot = 1;
   }
 
@@ -269,17 +477,32 @@ namespace QtLua {
   {
     QObject &obj = get_object();
     String skey = key.to_string();
+    Member::ptr m = MetaCache::get_meta(obj).get_member(skey);
+
+    // methods do not depend on object state, keep them in the per
+    // class metatable so that next lookups do not get here
+    if (m.valid() && m.dynamiccast<Method>().valid())
+      {
+	Value v(m->access(*this));
+	meta_index_cache(ls, key, v);
+	return v;
+      }
 
     // handle children access
     if (QObject *child = get_child(obj, skey))
       return Value(ls, QObjectWrapper::get_wrapper(ls, child));
 
     // fallback to member read access
-    Member::ptr m = MetaCache::get_meta(obj).get_member(skey);
-
     return m.valid() ? m->access(*this) : Value(ls);
   }
 
+  const void * QObjectWrapper::get_class_key() const
+  {
+    // metatables are not shared between QObject classes because
+    // cached methods are specific to a QMetaObject
+    return _obj ? (const void*)_obj->metaObject() : UserData::get_class_key();
+  }
+
   void QObjectWrapper::reparent(QObject *parent)
   {
     assert(_obj);
@@ -84,7 +84,7 @@ namespace QtLua {
     {
       Value::List meta_call(State &ls, const Value::List &args)
       {
-	meta_call_check_args(args, 3, 4, Value::TUserData, Value::TString, Value::TNone, Value::TString);
+	meta_call_check_args(args, 3, 4, Value::TUserData, Value::TString, Value::TNone, Value::TNone);
 
 	QObjectWrapper::ptr sigqow = args[0].to_userdata_cast<QObjectWrapper>();
 	QObject &sigobj = sigqow->get_object();
@@ -104,6 +104,28 @@ namespace QtLua {
 	  }
 
 	  case 4: {
+	    if (args[3].type() == Value::TTable)
+	      {
+		// connect qt signal to lua function with delivery options
+		const Value &opts = args[3];
+		Value::ConnectFlags flags = Value::ConnectDefault;
+
+		if (opts["coalesce"].to_boolean())
+		  flags |= Value::ConnectCoalesce;
+
+		if (opts["queued"].to_boolean())
+		  flags |= Value::ConnectQueued;
+
+		Value rate = opts["max_rate"];
+		unsigned int max_rate = rate.type() == Value::TNil ? 0 : std::max(0, rate.to_integer());
+
+		sigqow->_lua_connect(sigindex, args[2], flags, max_rate);
+		return Value::List();
+	      }
+
+	    if (args[3].type() != Value::TString)
+	      throw String("Wrong type for argument 4, lua::string or lua::table expected.");
+
 	    // connect qt signal to qt slot
 	    QObject &sloobj = args[2].to_userdata_cast<QObjectWrapper>()->get_object();	
 	    Method::ptr slo = MetaCache::get_meta(sloobj).get_member_throw<Method>(args[3].to_string());
@@ -130,7 +152,8 @@ namespace QtLua {
       String get_help() const
       {
 	return ("usage: qt.connect(qobjectwrapper, \"qt_signal_name\", qobjectwrapper, \"qt_slot_name\")\n"
-		"       qt.connect(qobjectwrapper, \"qt_signal_name\", lua_function)\n");
+		"       qt.connect(qobjectwrapper, \"qt_signal_name\", lua_function)\n"
+		"       qt.connect(qobjectwrapper, \"qt_signal_name\", lua_function, { coalesce = true, max_rate = 60 })\n");
       }
     } connect;
 
@@ -0,0 +1,105 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include <QMutexLocker>
+
+#include <internal/SignalQueue>
+
+namespace QtLua {
+
+  static QAtomicPointer<SignalRelay> relay_instance;
+
+  SignalRelay & SignalRelay::instance()
+  {
+    SignalRelay *r = relay_instance.fetchAndAddAcquire(0);
+
+    if (!r)
+      {
+	SignalRelay *n = new SignalRelay();
+
+	if (relay_instance.testAndSetOrdered(0, n))
+	  r = n;
+	else
+	  {
+	    delete n;
+	    r = relay_instance.fetchAndAddAcquire(0);
+	  }
+      }
+
+    // never destroyed, see class documentation
+    return *r;
+  }
+
+  SignalRelay::SignalRelay()
+    : _next_id(0)
+  {
+  }
+
+  int SignalRelay::add(const Entry &e)
+  {
+    int id = _next_id.fetchAndAddRelaxed(1);
+    Shard &s = shard(id);
+    QMutexLocker locker(&s._lock);
+
+    s._entries.insert(id, e);
+    return id;
+  }
+
+  void SignalRelay::remove(int relay_id)
+  {
+    Shard &s = shard(relay_id);
+    QMutexLocker locker(&s._lock);
+
+    s._entries.remove(relay_id);
+  }
+
+  int SignalRelay::qt_metacall(QMetaObject::Call c, int id, void **qt_args)
+  {
+    id = QObject::qt_metacall(c, id, qt_args);
+
+    if (id < 0 || c != QMetaObject::InvokeMetaMethod)
+      return id;
+
+    // entry and queue stay valid while the shard lock is held
+    Shard &s = shard(id);
+    QMutexLocker locker(&s._lock);
+    QHash<int, Entry>::const_iterator i = s._entries.constFind(id);
+
+    // connection has been removed meanwhile
+    if (i == s._entries.constEnd())
+      return -1;
+
+    const Entry &e = i.value();
+    SignalQueue::Node *n = e._queue->alloc();
+
+    n->_sender = e._sender;
+    n->_slot_id = e._slot_id;
+    n->_serial = e._serial;
+    n->_args.resize(e._types.size());
+    for (int j = 0; j < e._types.size(); j++)
+      n->_args[j] = QVariant(e._types[j], qt_args[j + 1]);
+
+    e._queue->push(n);
+
+    return -1;
+  }
+
+}
+
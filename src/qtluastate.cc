@@ -21,6 +21,7 @@
 #include "config.hh"
 
 #include <cstdlib>
+#include <typeinfo>
 
 #include <QStringList>
 
@@ -32,6 +33,7 @@
 #include <QtLua/String>
 #include <QtLua/Function>
 #include <internal/QObjectWrapper>
+#include <internal/SignalQueue>
 
 #include "qtluaqtlib.hh"
 
@@ -44,6 +46,8 @@ extern "C" {
 namespace QtLua {
 
 char State::_key_item_metatable;
+char State::_key_item_cache;
+char State::_key_item_index;
 char State::_key_this;
 
 /************************************************************************
@@ -144,6 +148,44 @@ int State::lua_cmd_plugin(lua_State *st)
   return 0;
 }
 
+int State::lua_cmd_to_table(lua_State *st)
+{
+  try {
+    State	*this_ = get_this(st);
+
+    if (lua_gettop(st) < 1)
+      {
+	this_->output_str("Usage: to_table(table_or_userdata)\n");
+	return 0;
+      }
+
+    lua_settop(st, 1);
+
+    if (lua_type(st, 1) == LUA_TTABLE)
+      return 1;
+
+    Value		v(1, this_);
+    Iterator::ptr	i = v.new_iterator();
+
+    lua_newtable(st);
+
+    for (; i->more(); i->next())
+      {
+	i->get_key().push_value();
+	i->get_value().push_value();
+	lua_rawset(st, -3);
+      }
+
+    return 1;
+
+  } catch (String &e) {
+    lua_pushstring(st, e.constData());
+    lua_error(st);
+  }
+
+  return 0;
+}
+
 int State::lua_cmd_list(lua_State *st)
 {
   try {
@@ -202,23 +244,45 @@ int State::lua_cmd_help(lua_State *st)
 
 // lua item metatable methods
 
+// Metatables functions are C closures with the State pointer as first
+// upvalue. Most of them are bound to a single metatable which is
+// stored as second upvalue. Lua only invokes a metamethod with an
+// object which has the metamethod in its metatable as first
+// argument, except for binary operators.
+
+#define LUA_META_THIS(st)						\
+  (static_cast<State*>(lua_touserdata(st, lua_upvalueindex(1))))
+
+#define LUA_META_UD(st, i)						\
+  (*static_cast<UserData::ptr*>(lua_touserdata(st, i)))
+
+// check if value has the metatable bound to the running closure
+static inline bool lua_meta_owns(lua_State *st, int i)
+{
+  bool res = false;
+
+  if (lua_getmetatable(st, i))
+    {
+      res = lua_rawequal(st, -1, lua_upvalueindex(2));
+      lua_pop(st, 1);
+    }
+
+  return res;
+}
+
 #define LUA_META_2OP_FUNC(n, op)					\
 									\
 int State::lua_meta_item_##n(lua_State *st)				\
 {									\
   int		x = lua_gettop(st);					\
-  State		*this_ = get_this(st);					\
+  State		*this_ = LUA_META_THIS(st);				\
 									\
   try {									\
     Value	a(1, this_);						\
     Value	b(2, this_);						\
+    UserData::ptr ud = LUA_META_UD(st, lua_meta_owns(st, 1) ? 1 : 2);	\
 									\
-    if (a.type() == Value::TUserData)					\
-      a.to_userdata()->meta_operation(*this_, op, a, b).push_value();	\
-    else if (b.type() == Value::TUserData)				\
-      b.to_userdata()->meta_operation(*this_, op, a, b).push_value();	\
-    else								\
-      std::abort();							\
+    ud->meta_operation(*this_, op, a, b).push_value();			\
 									\
   } catch (String &e) {							\
     lua_pushstring(st, e.constData());					\
@@ -233,12 +297,36 @@ int State::lua_meta_item_##n(lua_State *st)				\
 int State::lua_meta_item_##n(lua_State *st)				\
 {									\
   int		x = lua_gettop(st);					\
-  State		*this_ = get_this(st);					\
+  State		*this_ = LUA_META_THIS(st);				\
 									\
   try {									\
     Value	a(1, this_);						\
 									\
-     a.to_userdata()->meta_operation(*this_, op, a, a).push_value();	\
+    LUA_META_UD(st, 1)->meta_operation(*this_, op, a, a).push_value();	\
+									\
+  } catch (String &e) {							\
+    lua_pushstring(st, e.constData());					\
+    lua_error(st);							\
+  }									\
+									\
+  return lua_gettop(st) - x;						\
+}
+
+// comparison closures are shared between all metatables, lua only
+// invokes them when both operands have the same metamethod.
+
+#define LUA_META_CMP_FUNC(n, op)					\
+									\
+int State::lua_meta_item_##n(lua_State *st)				\
+{									\
+  int		x = lua_gettop(st);					\
+  State		*this_ = LUA_META_THIS(st);				\
+									\
+  try {									\
+    Value	a(1, this_);						\
+    Value	b(2, this_);						\
+									\
+    LUA_META_UD(st, 1)->meta_operation(*this_, op, a, b).push_value();	\
 									\
   } catch (String &e) {							\
     lua_pushstring(st, e.constData());					\
@@ -257,17 +345,32 @@ LUA_META_2OP_FUNC(pow, Value::OpPow)
 LUA_META_1OP_FUNC(unm, Value::OpUnm)
 LUA_META_2OP_FUNC(concat, Value::OpConcat)
 LUA_META_1OP_FUNC(len, Value::OpLen)
-LUA_META_2OP_FUNC(eq, Value::OpEq)
-LUA_META_2OP_FUNC(lt, Value::OpLt)
-LUA_META_2OP_FUNC(le, Value::OpLe)
+LUA_META_CMP_FUNC(eq, Value::OpEq)
+LUA_META_CMP_FUNC(lt, Value::OpLt)
+LUA_META_CMP_FUNC(le, Value::OpLe)
 
 int State::lua_meta_item_index(lua_State *st)
 {
   int		x = lua_gettop(st);
-  State		*this_ = get_this(st);
+  State		*this_ = LUA_META_THIS(st);
+
+  // lookup values stored by UserData::meta_index_cache first
+  lua_pushlightuserdata(st, &_key_item_index);
+  lua_rawget(st, lua_upvalueindex(2));
+
+  if (lua_istable(st, -1))
+    {
+      lua_pushvalue(st, 2);
+      lua_rawget(st, -2);
+
+      if (!lua_isnil(st, -1))
+	return 1;
+    }
+
+  lua_settop(st, x);
 
   try {
-    UserData::ptr ud = UserData::get_ud(st, 1);
+    UserData::ptr ud = LUA_META_UD(st, 1);
 
     if (!ud.valid())
       throw String("Can not index null lua::userdata value.");
@@ -289,10 +392,10 @@ int State::lua_meta_item_index(lua_State *st)
 int State::lua_meta_item_newindex(lua_State *st)
 {
   int		x = lua_gettop(st);
-  State		*this_ = get_this(st);
+  State		*this_ = LUA_META_THIS(st);
 
   try {
-    UserData::ptr ud = UserData::get_ud(st, 1);
+    UserData::ptr ud = LUA_META_UD(st, 1);
 
     if (!ud.valid())
       throw String("Can not index null lua::userdata value.");
@@ -313,10 +416,10 @@ int State::lua_meta_item_newindex(lua_State *st)
 int State::lua_meta_item_call(lua_State *st)
 {
   int		n = lua_gettop(st);
-  State		*this_ = get_this(st);
+  State		*this_ = LUA_META_THIS(st);
 
   try {
-    UserData::ptr ud = UserData::get_ud(st, 1);
+    UserData::ptr ud = LUA_META_UD(st, 1);
 
     if (!ud.valid())
       throw String("Can not call null lua::userdata value.");
@@ -347,11 +450,116 @@ int State::lua_meta_item_call(lua_State *st)
 
 int State::lua_meta_item_gc(lua_State *st)
 {
-  UserData::get_ud(st, 1).~Ref<UserData>();
+  LUA_META_UD(st, 1).~Ref<UserData>();
 
   return 0;
 }
 
+void State::push_metatable(lua_State *st, const UserData &ud)
+{
+  // operations bound only when supported, other metamethods are
+  // always present because objects may not report them or decide
+  // at run time.
+  static const Value::Operation optional_ops[] = {
+    Value::OpAdd, Value::OpSub, Value::OpMul, Value::OpDiv,
+    Value::OpMod, Value::OpPow, Value::OpUnm, Value::OpConcat,
+    Value::OpLen
+  };
+
+  int ops = 0;
+
+  for (unsigned int i = 0; i < sizeof(optional_ops) / sizeof(optional_ops[0]); i++)
+    if (ud.support(optional_ops[i]))
+      ops |= optional_ops[i];
+
+  // get table of metatables for this class key
+  lua_pushlightuserdata(st, &_key_item_metatable);
+  lua_rawget(st, LUA_REGISTRYINDEX);
+  int root = lua_gettop(st);
+
+  lua_pushlightuserdata(st, (void*)ud.get_class_key());
+  lua_rawget(st, root);
+
+  if (lua_isnil(st, -1))
+    {
+      lua_pop(st, 1);
+      lua_newtable(st);
+      lua_pushlightuserdata(st, (void*)ud.get_class_key());
+      lua_pushvalue(st, -2);
+      lua_rawset(st, root);
+    }
+
+  // get metatable for supported operations
+  lua_rawgeti(st, -1, ops);
+
+  if (lua_isnil(st, -1))
+    {
+      lua_pop(st, 1);
+
+      State *this_ = get_this(st);
+
+      lua_newtable(st);
+      int mt = lua_gettop(st);
+
+      // generic QtLua::UserData marker
+      lua_pushlightuserdata(st, &_key_item_metatable);
+      lua_pushboolean(st, 1);
+      lua_rawset(st, mt);
+
+      // prevent access from lua code
+      lua_pushstring(st, "__metatable");
+      lua_pushstring(st, "QtLua::UserData");
+      lua_rawset(st, mt);
+
+#define LUA_META_BIND(n)				\
+      lua_pushstring(st, "__" #n);			\
+      lua_pushlightuserdata(st, this_);			\
+      lua_pushvalue(st, mt);				\
+      lua_pushcclosure(st, lua_meta_item_##n, 2);	\
+      lua_rawset(st, mt);
+
+#define LUA_META_BIND_OP(n, op)				\
+      if (ops & op)					\
+	{						\
+	  LUA_META_BIND(n);				\
+	}
+
+#define LUA_META_BIND_SHARED(n)				\
+      lua_pushstring(st, "__" #n);			\
+      lua_pushstring(st, "__" #n);			\
+      lua_rawget(st, root);				\
+      lua_rawset(st, mt);
+
+      LUA_META_BIND_OP(add, Value::OpAdd);
+      LUA_META_BIND_OP(sub, Value::OpSub);
+      LUA_META_BIND_OP(mul, Value::OpMul);
+      LUA_META_BIND_OP(div, Value::OpDiv);
+      LUA_META_BIND_OP(mod, Value::OpMod);
+      LUA_META_BIND_OP(pow, Value::OpPow);
+      LUA_META_BIND_OP(unm, Value::OpUnm);
+      LUA_META_BIND_OP(concat, Value::OpConcat);
+      LUA_META_BIND_OP(len, Value::OpLen);
+      LUA_META_BIND_SHARED(eq);
+      LUA_META_BIND_SHARED(lt);
+      LUA_META_BIND_SHARED(le);
+      LUA_META_BIND(index);
+      LUA_META_BIND(newindex);
+      LUA_META_BIND(call);
+      LUA_META_BIND(gc);
+
+#undef LUA_META_BIND
+#undef LUA_META_BIND_OP
+#undef LUA_META_BIND_SHARED
+
+      lua_pushvalue(st, mt);
+      lua_rawseti(st, mt - 1, ops);
+    }
+
+  // keep metatable only
+  lua_replace(st, root);
+  lua_settop(st, root);
+}
+
 /************************************************************************/
 
 bool State::set_global_r(const String &name, const Value &value, int tblidx)
@@ -467,6 +675,7 @@ ValueRef State::operator[] (const Value &key)
 }
 
 State::State()
+  : _conversions(ConvertDefault)
 {
   assert(Value::TNone == LUA_TNONE);
   assert(Value::TNil == LUA_TNIL);
@@ -482,37 +691,39 @@ State::State()
   if (!_lst)
     throw std::bad_alloc();
 
+  _signal_queue = new SignalQueue(this);
+
   //lua_atpanic(_lst, lua_panic);
 
-  // creat metatable for UserData events
+  // create table of UserData metatables, shared comparison
+  // metamethods are stored here too
 
   lua_pushlightuserdata(_lst, &_key_item_metatable);
   lua_newtable(_lst);
 
-#define LUA_META_BIND(n)			\
+#define LUA_META_BIND_CMP(n)				\
   lua_pushstring(_lst, "__" #n);			\
-  lua_pushcfunction(_lst, lua_meta_item_##n);	\
+  lua_pushlightuserdata(_lst, this);			\
+  lua_pushcclosure(_lst, lua_meta_item_##n, 1);		\
   lua_rawset(_lst, -3);
 
-  LUA_META_BIND(add);
-  LUA_META_BIND(sub);
-  LUA_META_BIND(mul);
-  LUA_META_BIND(div);
-  LUA_META_BIND(mod);
-  LUA_META_BIND(pow);
-  LUA_META_BIND(unm);
-  LUA_META_BIND(concat);
-  LUA_META_BIND(len);
-  LUA_META_BIND(eq);
-  LUA_META_BIND(lt);
-  LUA_META_BIND(le);
-  LUA_META_BIND(index);
-  LUA_META_BIND(newindex);
-  LUA_META_BIND(call);
-  LUA_META_BIND(gc);
+  LUA_META_BIND_CMP(eq);
+  LUA_META_BIND_CMP(lt);
+  LUA_META_BIND_CMP(le);
 
   lua_rawset(_lst, LUA_REGISTRYINDEX);
 
+  // create weak table of lua user data bound to UserData objects
+
+  lua_pushlightuserdata(_lst, &_key_item_cache);
+  lua_newtable(_lst);
+  lua_newtable(_lst);
+  lua_pushstring(_lst, "__mode");
+  lua_pushstring(_lst, "v");
+  lua_rawset(_lst, -3);
+  lua_setmetatable(_lst, -2);
+  lua_rawset(_lst, LUA_REGISTRYINDEX);
+
   // pointer to this
 
   lua_pushlightuserdata(_lst, &_key_this);
@@ -534,6 +745,16 @@ State::~State()
 
   while ((i = _whash.begin()) != _whash.end())
     i.value()->_drop();
+
+  delete _signal_queue;
+}
+
+void State::customEvent(QEvent *event)
+{
+  if (event->type() == SignalQueue::event_type())
+    QObjectWrapper::_lua_queue_drain(*this);
+  else
+    QObject::customEvent(event);
 }
 
 int State::lua_panic(lua_State *st)
@@ -739,6 +960,7 @@ void State::openlib(Library lib)
       reg_c_function("each", lua_cmd_each);
       reg_c_function("help", lua_cmd_help);
       reg_c_function("plugin", lua_cmd_plugin);
+      reg_c_function("to_table", lua_cmd_to_table);
       return;
     case QtLib:
       qtluaopen_qt(*this);
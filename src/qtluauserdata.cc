@@ -20,6 +20,7 @@
 
 
 #include <cstdarg>
+#include <cstdlib>
 
 #ifdef __GNUC__
 #include <cxxabi.h>
@@ -29,6 +30,10 @@ extern "C" {
 #include <lua.h>
 }
 
+#include <QMutex>
+#include <QThreadStorage>
+#include <QVector>
+
 #include <QtLua/UserData>
 #include <QtLua/Value>
 #include <QtLua/State>
@@ -38,47 +43,86 @@ namespace QtLua {
 
 void UserData::push_ud(lua_State *st)
 {
+  // look for a lua user data already bound to 'this'
+  lua_pushlightuserdata(st, &State::_key_item_cache);
+  lua_rawget(st, LUA_REGISTRYINDEX);
+  lua_pushlightuserdata(st, this);
+  lua_rawget(st, -2);
+
+  if (!lua_isnil(st, -1))
+    {
+      lua_remove(st, -2);
+
+      // supported operations may have changed since first push,
+      // attach the metatable matching the current mask
+      lua_getmetatable(st, -1);
+      State::push_metatable(st, *this);
+
+      if (lua_rawequal(st, -1, -2))
+	lua_pop(st, 2);
+      else
+	{
+	  lua_remove(st, -2);
+	  lua_setmetatable(st, -2);
+	}
+
+      return;
+    }
+
+  lua_pop(st, 1);
+
   // allocate lua user data to store reference to 'this'
   new (lua_newuserdata(st, sizeof (UserData::ptr))) UserData::ptr(*this);
 
   // attach metatable
-  lua_pushlightuserdata(st, &State::_key_item_metatable);
-  lua_rawget(st, LUA_REGISTRYINDEX);
+  State::push_metatable(st, *this);
   lua_setmetatable(st, -2);
+
+  // keep in weak cache for later reuse
+  lua_pushlightuserdata(st, this);
+  lua_pushvalue(st, -2);
+  lua_rawset(st, -4);
+  lua_remove(st, -2);
 }
 
-template <bool pop>
-inline QtLua::Ref<UserData> UserData::get_ud_(lua_State *st, int i)
+QtLua::Ref<UserData> UserData::try_get_ud(lua_State *st, int i)
 {
-#ifndef QTLUA_NO_USERDATA_CHECK
+  bool ours = false;
+
+  // all UserData metatables contain a marker entry
   if (lua_getmetatable(st, i))
     {
       lua_pushlightuserdata(st, &State::_key_item_metatable);
-      lua_rawget(st, LUA_REGISTRYINDEX);
+      lua_rawget(st, -2);
+      ours = lua_toboolean(st, -1);
+      lua_pop(st, 2);
+    }
 
-      if (lua_rawequal(st, -2, -1))
-	{
-	  lua_pop(st, 2);
-#endif
-	  UserData::ptr	*item = static_cast<UserData::ptr *>(lua_touserdata(st, i));
+  if (!ours)
+    return UserData::ptr();
 
-	  if (pop)
-	    lua_pop(st, 1);
+  return *static_cast<UserData::ptr *>(lua_touserdata(st, i));
+}
 
-	  return *item;
+template <bool pop>
+inline QtLua::Ref<UserData> UserData::get_ud_(lua_State *st, int i)
+{
 #ifndef QTLUA_NO_USERDATA_CHECK
-	}
+  UserData::ptr item = try_get_ud(st, i);
 
-      lua_pop(st, 1);
-    }
+  if (pop)
+    lua_pop(st, 1);
 
-  lua_pop(st, 1);
+  if (!item.valid())
+    throw String("Lua userdata is not a QtLua::UserData.");
+#else
+  UserData::ptr item = *static_cast<UserData::ptr *>(lua_touserdata(st, i));
 
   if (pop)
     lua_pop(st, 1);
-
-  throw String("Lua userdata is not a QtLua::UserData.");
 #endif
+
+  return item;
 }
 
 QtLua::Ref<UserData> UserData::get_ud(lua_State *st, int i)
@@ -91,14 +135,146 @@ QtLua::Ref<UserData> UserData::pop_ud(lua_State *st)
   return get_ud_<true>(st, -1);
 }
 
-String UserData::get_type_name() const
+struct TypeRegistry
+{
+  QMutex _lock;
+  // type_info objects may not be unique across shared objects
+  QHash<const std::type_info *, int> _by_info;
+  QHash<QByteArray, int> _by_name;
+  QVector<String> _names;
+};
+
+static TypeRegistry & type_registry()
+{
+  static TypeRegistry reg;
+  return reg;
+}
+
+// per thread copy of registry lookups, the shared registry is only
+// locked the first time a thread sees a type
+struct TypeCache
+{
+  QHash<const std::type_info *, int> _by_info;
+  QVector<String> _names;
+};
+
+static TypeCache & type_cache()
+{
+  static QThreadStorage<TypeCache *> storage;
+
+  if (!storage.hasLocalData())
+    storage.setLocalData(new TypeCache);
+
+  return *storage.localData();
+}
+
+static String demangle(const char *name)
 {
 #ifdef __GNUC__
   int s;
-  return abi::__cxa_demangle(typeid(*this).name(), 0, 0, &s);
-#else
-  return typeid(*this).name();
+  char *d = abi::__cxa_demangle(name, 0, 0, &s);
+
+  if (d)
+    {
+      String res(d);
+      std::free(d);
+      return res;
+    }
 #endif
+  return String(name);
+}
+
+int UserData::type_info_id(const std::type_info &ti)
+{
+  TypeCache &cache = type_cache();
+  int id = cache._by_info.value(&ti);
+
+  if (id)
+    return id;
+
+  TypeRegistry &reg = type_registry();
+  QMutexLocker lock(&reg._lock);
+
+  id = reg._by_info.value(&ti);
+
+  if (id)
+    {
+      cache._by_info.insert(&ti, id);
+      return id;
+    }
+
+  QByteArray name(ti.name());
+  id = reg._by_name.value(name);
+
+  if (!id)
+    {
+      reg._names.push_back(demangle(ti.name()));
+      id = reg._names.size();
+      reg._by_name.insert(name, id);
+    }
+
+  reg._by_info.insert(&ti, id);
+  cache._by_info.insert(&ti, id);
+  return id;
+}
+
+String UserData::type_id_name(int id)
+{
+  TypeCache &cache = type_cache();
+
+  if (id < 1 || id > cache._names.size())
+    {
+      TypeRegistry &reg = type_registry();
+      QMutexLocker lock(&reg._lock);
+
+      // implicitly shared, names are never modified once registered
+      cache._names = reg._names;
+    }
+
+  return cache._names.value(id - 1);
+}
+
+int UserData::get_type_id() const
+{
+  return type_info_id(typeid(*this));
+}
+
+const void * UserData::get_class_key() const
+{
+  return &typeid(*this);
+}
+
+void UserData::meta_index_cache(State &ls, const Value &key, const Value &value)
+{
+  lua_State *st = ls._lst;
+
+  // use the metatable actually attached to the lua userdata, the
+  // one selected from the current support() mask may differ
+  push_ud(st);
+  lua_getmetatable(st, -1);
+  lua_remove(st, -2);
+
+  lua_pushlightuserdata(st, &State::_key_item_index);
+  lua_rawget(st, -2);
+
+  if (lua_isnil(st, -1))
+    {
+      lua_pop(st, 1);
+      lua_newtable(st);
+      lua_pushlightuserdata(st, &State::_key_item_index);
+      lua_pushvalue(st, -2);
+      lua_rawset(st, -4);
+    }
+
+  key.push_value();
+  value.push_value();
+  lua_rawset(st, -3);
+  lua_pop(st, 2);
+}
+
+String UserData::get_type_name() const
+{
+  return type_id_name(get_type_id());
 }
 
 String UserData::get_value_str() const
@@ -123,9 +299,16 @@ Value UserData::meta_index(State &ls, const Value &key)
 };
 
 bool UserData::meta_contains(State &ls, const Value &key)
+{
+  Value value(ls);
+  return meta_find(ls, key, value);
+}
+
+bool UserData::meta_find(State &ls, const Value &key, Value &value)
 {
   try {
-    return !meta_index(ls, key).is_nil();
+    value = meta_index(ls, key);
+    return !value.is_nil();
   } catch (String &e) {
     return false;
   }
@@ -174,11 +174,17 @@ Value & Value::operator=(QObject *obj)
 Value & Value::operator=(const QVariant &qv)
 {
   if (_st)
-    *this = Member::raw_get_object(*_st, qv.type(), qv.constData());
+    {
+      lua_State *lst = _st->_lst;
+      Member::raw_push(*_st, qv.userType(), qv.constData());
+      lua_pushlightuserdata(lst, this);
+      lua_insert(lst, -2);
+      lua_rawset(lst, LUA_REGISTRYINDEX);
+    }
   return *this;
 }
 
-bool Value::connect(QObject *obj, const char *signal)
+bool Value::connect(QObject *obj, const char *signal, ConnectFlags flags, unsigned int max_rate)
 {
   check_state();
   try {
@@ -190,7 +196,7 @@ bool Value::connect(QObject *obj, const char *signal)
     if (sigid < 0 || mo->method(sigid).methodType() != QMetaMethod::Signal)
       return false;
 
-    qow->_lua_connect(sigid, *this);
+    qow->_lua_connect(sigid, *this, flags, max_rate);
 
   } catch (const String &e) {
     return false;
@@ -435,17 +441,12 @@ String Value::type_name_u() const
 
   if (t == TUserData)
     {
-#ifndef QTLUA_NO_USERDATA_CHECK
-      try {
-#endif
-	UserData::ptr ud = UserData::get_ud(lst, -1);
-	lua_pop(lst, 1);
-	if (ud.valid())
+      UserData::ptr ud = UserData::try_get_ud(lst, -1);
+      if (ud.valid())
+	{
+	  lua_pop(lst, 1);
 	  return ud->get_type_name();
-#ifndef QTLUA_NO_USERDATA_CHECK
-      } catch (const String &e) {
-      }
-#endif
+	}
     }
 
   lua_pop(lst, 1);
@@ -476,7 +477,7 @@ void Value::convert_error(ValueType type) const
     .arg(lua_typename(lst, type_b)).arg(lua_typename(lst, (int)type));
 }
 
-lua_Number Value::to_number() const
+bool Value::try_to_number(double &res) const
 {
   push_value();
   lua_State *lst = _st->_lst;
@@ -484,23 +485,37 @@ lua_Number Value::to_number() const
   switch (lua_type(lst, -1))
     {
     case LUA_TBOOLEAN:
-    case LUA_TNUMBER: {
-      lua_Number res = lua_tonumber(lst, -1);
+    case LUA_TNUMBER:
+      res = lua_tonumber(lst, -1);
       lua_pop(lst, 1);
-      return res;
-    }
+      return true;
 
     case LUA_TSTRING: {
       char *end;
-      lua_Number res = strtod(lua_tostring(lst, -1), &end);
+      lua_Number n = strtod(lua_tostring(lst, -1), &end);
       lua_pop(lst, 1);
 
-      if (!*end)
-	return res;
+      if (*end)
+	return false;
+
+      res = n;
+      return true;
     }
 
+    default:
+      lua_pop(lst, 1);
+      return false;
     }
+}
 
+lua_Number Value::to_number() const
+{
+  double res;
+
+  if (try_to_number(res))
+    return res;
+
+  push_value();
   convert_error(TNumber);
   std::abort();
 }
@@ -561,17 +576,10 @@ String Value::to_string_p(lua_State *st, int index, bool quote_string)
 	return String(lua_tostring(st, index));
 
     case TUserData: {
-#ifndef QTLUA_NO_USERDATA_CHECK
-      try {
-#endif
-	UserData::ptr ud = UserData::get_ud(st, index);
-	String res(ud.valid() ? ud->get_value_str() : ud->UserData::get_value_str());
-	return res;
-#ifndef QTLUA_NO_USERDATA_CHECK
-      } catch (const String &e) {
-	// goto default
-      }
-#endif
+      UserData::ptr ud = UserData::try_get_ud(st, index);
+      if (ud.valid())
+	return ud->get_value_str();
+      // goto default
     }
 
     default: {
@@ -617,22 +625,33 @@ UserData::ptr Value::to_userdata_null() const
   push_value();
   lua_State *lst = _st->_lst;
 
+  UserData::ptr ptr;
+
   if (lua_type(lst, -1) == LUA_TUSERDATA)
+    ptr = UserData::try_get_ud(lst, -1);
+
+  lua_pop(lst, 1);
+  return ptr;
+}
+
+const void * Value::to_pointer() const
+{
+  if (!_st)
+    return 0;
+
+  if (type() == TUserData)
     {
-#ifndef QTLUA_NO_USERDATA_CHECK
-      try {
-#endif
-	UserData::ptr ptr = UserData::get_ud(lst, -1);
-	lua_pop(lst, 1);
-	return ptr;
-#ifndef QTLUA_NO_USERDATA_CHECK
-      } catch (const String &e) {
-      }
-#endif
+      UserData::ptr ud = to_userdata_null();
+
+      if (ud.valid())
+	return ud.ptr();
     }
 
+  push_value();
+  lua_State *lst = _st->_lst;
+  const void *res = lua_topointer(lst, -1);
   lua_pop(lst, 1);
-  return UserData::ptr();
+  return res;
 }
 
 QObject *Value::to_qobject() const
@@ -647,21 +666,39 @@ QObject *Value::to_qobject() const
 
 QVariant Value::to_qvariant() const
 {
-  switch (type())
-    {
-    case TNone:
-    case TNil:
-      return QVariant();
-    case TBool:
-      return QVariant(to_boolean());
-    case TNumber:
-      return QVariant(to_number());
-    case TString:
-      return QVariant(to_string());
+  QVariant res;
 
-    default:
-      throw String("Can not convert % type to QVariant.").arg(type_name());
-    }
+  if (_st)
+    Member::raw_set_object(QMetaType::QVariant, &res, *this);
+
+  return res;
+}
+
+QVariantList Value::to_qvariantlist() const
+{
+  QVariantList res;
+
+  check_state();
+  Member::raw_set_object(QMetaType::QVariantList, &res, *this);
+  return res;
+}
+
+QVariantMap Value::to_qvariantmap() const
+{
+  QVariantMap res;
+
+  check_state();
+  Member::raw_set_object(QMetaType::QVariantMap, &res, *this);
+  return res;
+}
+
+QVariantHash Value::to_qvarianthash() const
+{
+  QVariantHash res;
+
+  check_state();
+  Member::raw_set_object(QMetaType::QVariantHash, &res, *this);
+  return res;
 }
 
 static int lua_writer(lua_State *L, const void* p, size_t sz, void* pv)
@@ -690,6 +727,55 @@ QByteArray Value::to_bytecode() const
   std::abort();
 }
 
+Value Value::new_table(const State &ls, int array_size, int hash_size)
+{
+  lua_State *lst = ls._lst;
+
+  lua_createtable(lst, array_size, hash_size);
+  Value res(-1, &ls);
+  lua_pop(lst, 1);
+
+  return res;
+}
+
+Value Value::raw_get(int index) const
+{
+  push_value();
+  lua_State *lst = _st->_lst;
+
+  int t = lua_type(lst, -1);
+
+  if (t != TTable)
+    {
+      lua_pop(lst, 1);
+      throw String("Can not index lua::% value.").arg(lua_typename(lst, t));
+    }
+
+  lua_rawgeti(lst, -1, index);
+  Value res(-1, _st);
+  lua_pop(lst, 2);
+
+  return res;
+}
+
+void Value::raw_set(int index, const Value &value)
+{
+  push_value();
+  lua_State *lst = _st->_lst;
+
+  int t = lua_type(lst, -1);
+
+  if (t != TTable)
+    {
+      lua_pop(lst, 1);
+      throw String("Can not index lua::% value.").arg(lua_typename(lst, t));
+    }
+
+  value.push_value();
+  lua_rawseti(lst, -2, index);
+  lua_pop(lst, 1);
+}
+
 int Value::len() const
 {
   push_value();
@@ -703,13 +789,14 @@ int Value::len() const
       res = lua_objlen(lst, -1);
       break;
 
-    case TUserData:
-      try {
-	UserData::ptr ptr = UserData::get_ud(lst, -1);
-	res = ptr->meta_operation(*_st, Value::OpLen, *this, *this).to_integer();
-	break;
-      } catch (const String &s) {
-      }
+    case TUserData: {
+      UserData::ptr ptr = UserData::try_get_ud(lst, -1);
+      if (ptr.valid() && ptr->support(Value::OpLen))
+	{
+	  res = ptr->meta_operation(*_st, Value::OpLen, *this, *this).to_integer();
+	  break;
+	}
+    }
 
     default:
       res = 0;
@@ -810,15 +897,12 @@ bool Value::support(Operation c) const
 	}
       break;
 
-    case TUserData:
-      try {
-	UserData::ptr ptr = UserData::get_ud(lst, -1);
-	res = ptr->support(c);
-      } catch (const String &s) {
-	res = false;
-      }
+    case TUserData: {
+      UserData::ptr ptr = UserData::try_get_ud(lst, -1);
+      res = ptr.valid() && ptr->support(c);
       break;
     }
+    }
 
   lua_pop(lst, 1);
   return res;
@@ -838,18 +922,13 @@ bool Value::operator==(const Value &lv) const
   if ((lua_type(lst, -1) == TUserData) &&
       (lua_type(lst, -2) == TUserData))
     {
-#ifndef QTLUA_NO_USERDATA_CHECK
-      try {
-#endif
-	UserData::ptr a = UserData::get_ud(lst, -1);
-	UserData::ptr b = UserData::get_ud(lst, -2);
-
-	res = (a.valid() == b.valid()) && (!a.valid() || (*a == *b));
-#ifndef QTLUA_NO_USERDATA_CHECK
-      } catch (const String &e) {
+      UserData::ptr a = UserData::try_get_ud(lst, -1);
+      UserData::ptr b = UserData::try_get_ud(lst, -2);
+
+      if (a.valid() && b.valid())
+	res = *a == *b;
+      else
 	res = lua_rawequal(lst, -1, -2);
-      }
-#endif
     }
   else
     {
@@ -874,18 +953,13 @@ bool Value::operator<(const Value &lv) const
   if ((lua_type(lst, -1) == TUserData) &&
       (lua_type(lst, -2) == TUserData))
     {
-#ifndef QTLUA_NO_USERDATA_CHECK
-      try {
-#endif
-	UserData::ptr a = UserData::get_ud(lst, -1);
-	UserData::ptr b = UserData::get_ud(lst, -2);
-
-	res = a.valid() && b.valid() && (*a < *b);
-#ifndef QTLUA_NO_USERDATA_CHECK
-      } catch (const String &e) {
+      UserData::ptr a = UserData::try_get_ud(lst, -1);
+      UserData::ptr b = UserData::try_get_ud(lst, -2);
+
+      if (a.valid() && b.valid())
+	res = *a < *b;
+      else
 	res = lua_topointer(lst, -1) < lua_topointer(lst, -2);
-      }
-#endif
     }
   else
     {
@@ -964,17 +1038,10 @@ uint Value::qHash(lua_State *lst, int index)
       return ::qHash(String(lua_tostring(lst, index), lua_strlen(lst, index)));
 
     case LUA_TUSERDATA: {
-#ifndef QTLUA_NO_USERDATA_CHECK
-      try {
-#endif
-	QtLua::Ref<UserData> ud = UserData::get_ud(lst, index);
+      QtLua::Ref<UserData> ud = UserData::try_get_ud(lst, index);
+      if (ud.valid())
 	return (uint)(long)ud.ptr();
-#ifndef QTLUA_NO_USERDATA_CHECK
-      } catch (...) {
-	return (uint)(long)lua_touserdata(lst, index);
-      }
-#endif
-      break;
+      return (uint)(long)lua_touserdata(lst, index);
     }
 
     default:
@@ -81,14 +81,15 @@ namespace QtLua {
     switch (t)
       {
       case TUserData:
-	try {
-	  UserData::ptr ud = UserData::get_ud(lst, -1);
-	  ud->meta_index(*_st, _key).push_value();
-	  lua_remove(lst, -2);
-
-	} catch (const String &e) {
+	{
+	  UserData::ptr ud = UserData::try_get_ud(lst, -1);
 	  lua_pop(lst, 1);
-	  lua_pushnil(lst);
+
+	  Value res(*_st);
+	  if (ud.valid() && ud->meta_find(*_st, _key, res))
+	    res.push_value();
+	  else
+	    lua_pushnil(lst);
 	}
 	break;
 
@@ -0,0 +1,88 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#include "test.hh"
+
+#include <QtLua/State>
+#include <QtLua/Value>
+
+#include "test_bind.hh"
+
+using namespace QtLua;
+
+int main()
+{
+  try {
+
+    {
+      QtLua::State ls;
+
+      ls.openlib(BaseLib);
+      ls.openlib(StringLib);
+      bindtest::string::qtlua_register(ls);
+
+      ls["s"] = QTLUA_REFNEW(bindtest::string);
+
+      ASSERT(ls.exec_statements("s.len = 2 return s:grow(3)").at(0).to_number() == 5);
+      ASSERT(ls.exec_statements("return s.id, s.twice(4)").at(1).to_number() == 8);
+
+      // globals are left untouched and not used for method lookup
+      ASSERT(ls.exec_statements("return string.format('%d', s.id)").at(0).to_string() == "42");
+      ls.exec_statements("string = nil bindtest = nil");
+      ASSERT(ls.exec_statements("return s:grow(1)").at(0).to_number() == 6);
+
+      bool err = false;
+      try {
+	ls.exec_statements("s.id = 1");
+      } catch (QtLua::String &e) {
+	err = true;
+      }
+      ASSERT(err);
+    }
+
+    {
+      QtLua::State ls;
+
+      // members are registered per State
+      bindtest::string::ptr s = QTLUA_REFNEW(bindtest::string);
+      ls["s"] = s;
+
+      Value v(ls);
+      ASSERT(!s->meta_find(ls, Value(ls, "grow"), v));
+      ASSERT(s->meta_find(ls, Value(ls, "len"), v) && v.to_number() == 0);
+
+      bool err = false;
+      try {
+	ls.exec_statements("return s:grow(1)");
+      } catch (QtLua::String &e) {
+	err = true;
+      }
+      ASSERT(err);
+      ASSERT(ls.exec_statements("return s.len").at(0).to_number() == 0);
+    }
+
+  } catch (QtLua::String &e) {
+    std::cout << e.constData() << std::endl;
+    ASSERT(0);
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,58 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+#ifndef TEST_BIND_HH_
+#define TEST_BIND_HH_
+
+#include <QtLua/UserData>
+#include <QtLua/Bind>
+
+namespace bindtest {
+
+  // named after the lua string library on purpose
+  class string : public QtLua::UserData
+  {
+    QTLUA_BIND_CLASS(bindtest::string)
+
+  public:
+    string()
+      : len(0), id(42)
+    {
+    }
+
+    QTLUA_BIND int len;
+    QTLUA_BIND_RO int id;
+
+    QTLUA_BIND int grow(int n)
+    {
+      len += n;
+      return len;
+    }
+
+    QTLUA_BIND static int twice(int n)
+    {
+      return 2 * n;
+    }
+  };
+
+}
+
+#endif
+
@@ -18,11 +18,32 @@
 
 */
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
 #include "test.hh"
 #include "test_qobject_arg.hh"
 
-int main()
+// run event loop until lua expression is true or timeout expires
+static bool wait_for(State &ls, const char *expr, int timeout = 2000)
+{
+  QElapsedTimer t;
+  t.start();
+
+  while (!ls.exec_statements(String("return ") + expr).at(0).to_boolean())
+    {
+      if (t.elapsed() > timeout)
+	return false;
+      QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+
+  return true;
+}
+
+int main(int argc, char *argv[])
 {
+  QCoreApplication app(argc, argv);
+
   try {
   {
     QtLua::State ls;
@@ -76,6 +97,161 @@ int main()
     ASSERT(myobj->_qo == qo);
   }
 
+  {
+    QtLua::State ls;
+    ls.openlib(QtLua::BaseLib);
+
+    UserData::ptr ud = QTLUA_REFNEW(MyData, 42);
+
+    // same lua userdata must be reused for same UserData object
+    ls["a"] = ud;
+    ls["b"] = ud;
+    ASSERT(ls.exec_statements("return rawequal(a, b)").at(0).to_boolean());
+
+    // metatable follows supported operations on reuse
+    UserData::ptr ld = QTLUA_REFNEW(MyLenData);
+    ls["l"] = ld;
+
+    bool err = false;
+    try {
+      ls.exec_statements("return #l");
+    } catch (const QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
+
+    ld.dynamiccast<MyLenData>()->_len = true;
+    ls["l2"] = ld;
+    ASSERT(ls.exec_statements("return #l, rawequal(l, l2)").at(0).to_integer() == 3);
+    ASSERT(ls.exec_statements("return #l, rawequal(l, l2)").at(1).to_boolean());
+
+    MyObjectQO *myobj = new MyObjectQO();
+
+    ls["o1"] = myobj;
+    ls["o2"] = myobj;
+    ASSERT(ls.exec_statements("return rawequal(o1, o2)").at(0).to_boolean());
+
+    // methods are cached in per class metatable
+    ls.exec_statements("m = o1.qo_slot");
+    ASSERT(ls.exec_statements("return rawequal(m, o2.qo_slot)").at(0).to_boolean());
+    ASSERT(ls.exec_statements("return rawequal(m, o1.qo_slot)").at(0).to_boolean());
+  }
+
+  {
+    UserData::ptr ud = QTLUA_REFNEW(MyData, 1);
+
+    ASSERT(ud->get_type_id() == UserData::type_id<MyData>());
+    ASSERT(UserData::type_id<MyData>() != UserData::type_id<UserData>());
+    ASSERT(UserData::type_name<MyData>() == ud->get_type_name());
+  }
+
+  {
+    QtLua::State ls;
+
+    MyObjectNum *myobj = new MyObjectNum();
+
+    ls.exec_statements("n = 0 function f(obj, v) n = n + 1; last = v; end");
+
+    ASSERT(ls["f"].connect(myobj, "num_arg(int)", Value::ConnectCoalesce));
+
+    // emissions are collapsed and delivered from the event loop
+    myobj->send(1);
+    myobj->send(2);
+    myobj->send(3);
+    ASSERT(ls["n"].to_integer() == 0);
+
+    ASSERT(wait_for(ls, "n > 0"));
+    ASSERT(ls["n"].to_integer() == 1 && ls["last"].to_integer() == 3);
+
+    ASSERT(ls["f"].disconnect(myobj, "num_arg(int)"));
+
+    // rate limited connection spaces calls by at least 100ms
+    ASSERT(ls["f"].connect(myobj, "num_arg(int)", Value::ConnectDefault, 10));
+
+    QElapsedTimer t;
+    myobj->send(4);
+    ASSERT(wait_for(ls, "n == 2"));
+    t.start();
+    myobj->send(5);
+    myobj->send(6);
+    ASSERT(wait_for(ls, "n == 3"));
+    ASSERT(t.elapsed() >= 90 && ls["last"].to_integer() == 6);
+
+    ASSERT(ls["f"].disconnect(myobj, "num_arg(int)"));
+  }
+
+  {
+    QtLua::State ls;
+
+    MyObjectNum *myobj = new MyObjectNum();
+
+    ls.exec_statements("n = 0 s = 0 function g(obj, v) n = n + 1; s = s + v; obj:record_thread() end");
+
+    ASSERT(ls["g"].connect(myobj, "num_arg(int)", Value::ConnectQueued));
+
+    // emissions from worker thread are delivered in State thread
+    EmitThread th(myobj, 100);
+    th.start();
+    th.wait();
+    ASSERT(ls["n"].to_integer() == 0);
+
+    ASSERT(wait_for(ls, "n == 100"));
+    ASSERT(ls["s"].to_integer() == 4950);
+    ASSERT(myobj->_thread == QThread::currentThread());
+
+    // emissions from State thread are queued too
+    myobj->send(1);
+    ASSERT(ls["n"].to_integer() == 100);
+    ASSERT(wait_for(ls, "n == 101"));
+
+    ASSERT(ls["g"].disconnect(myobj, "num_arg(int)"));
+    myobj->send(1);
+    QCoreApplication::processEvents();
+    ASSERT(ls["n"].to_integer() == 101);
+  }
+
+  {
+    QtLua::State ls;
+    ls.openlib(QtLua::QtLib);
+
+    MyObjectNum *myobj = new MyObjectNum();
+    ls["o"] = myobj;
+
+    ls.exec_statements("a = 0 b = 0 function fa(obj, v) a = a + v end function fb(obj, v) b = b + v end");
+
+    // released slot ids are reused
+    for (int i = 0; i < 100; i++)
+      {
+	ASSERT(ls["fa"].connect(myobj, "num_arg(int)"));
+	ASSERT(ls["fa"].disconnect(myobj, "num_arg(int)"));
+      }
+
+    ASSERT(ls["fa"].connect(myobj, "num_arg(int)"));
+    ASSERT(ls["fb"].connect(myobj, "num_arg(int)"));
+    ASSERT(ls["fb"].connect(myobj, "num_arg(int)"));
+    myobj->send(1);
+    ASSERT(ls["a"].to_integer() == 1 && ls["b"].to_integer() == 2);
+
+    // only one connection of the given value is removed
+    ASSERT(ls["fb"].disconnect(myobj, "num_arg(int)"));
+    myobj->send(1);
+    ASSERT(ls["a"].to_integer() == 2 && ls["b"].to_integer() == 3);
+
+    ASSERT(ls["fa"].disconnect(myobj, "num_arg(int)"));
+    ASSERT(!ls["fa"].disconnect(myobj, "num_arg(int)"));
+    myobj->send(1);
+    ASSERT(ls["a"].to_integer() == 2 && ls["b"].to_integer() == 4);
+
+    // disconnect all lua values from signal
+    ls.exec_statements("qt.disconnect(o, 'num_arg')");
+    myobj->send(1);
+    ASSERT(ls["b"].to_integer() == 4);
+
+    ASSERT(ls["fa"].connect(myobj, "num_arg(int)"));
+    myobj->send(1);
+    ASSERT(ls["a"].to_integer() == 3 && ls["b"].to_integer() == 4);
+  }
+
   } catch (QtLua::String &e) {
     std::cout << e.constData() << std::endl;
     ASSERT(0);
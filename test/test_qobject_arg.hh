@@ -23,6 +23,7 @@
 #include <QtLua/UserData>
 
 #include <QObject>
+#include <QThread>
 
 using namespace QtLua;
 
@@ -68,6 +69,26 @@ struct MyData : public UserData
   double _data;
 };
 
+struct MyLenData : public UserData
+{
+  MyLenData()
+    : _len(false)
+  {
+  }
+
+  bool support(Value::Operation c) const
+  {
+    return c == Value::OpLen ? _len : UserData::support(c);
+  }
+
+  Value meta_operation(State &ls, Value::Operation op, const Value &a, const Value &b)
+  {
+    return Value(ls, 3);
+  }
+
+  bool _len;
+};
+
 struct MyObjectQO : public QObject
 {
   Q_OBJECT;
@@ -95,3 +116,48 @@ public:
   void qo_arg(QObject *o);
 };
 
+struct MyObjectNum : public QObject
+{
+  Q_OBJECT;
+public:
+  MyObjectNum()
+    : QObject(0),
+      _thread(0)
+  {
+  }
+
+  void send(int n)
+  {
+    emit num_arg(n);
+  }
+
+  QThread * _thread;
+
+ public slots:
+  void record_thread()
+  {
+    _thread = QThread::currentThread();
+  }
+
+ signals:
+  void num_arg(int n);
+};
+
+struct EmitThread : public QThread
+{
+  EmitThread(MyObjectNum *obj, int count)
+    : _obj(obj),
+      _count(count)
+  {
+  }
+
+  void run()
+  {
+    for (int i = 0; i < _count; i++)
+      _obj->send(i);
+  }
+
+  MyObjectNum *_obj;
+  int _count;
+};
+
@@ -20,11 +20,102 @@
 
 #include "test.hh"
 
+#include <QLinkedList>
+#include <QMap>
+#include <QTemporaryFile>
+#include <QMetaType>
+
 #include <QtLua/State>
 #include <QtLua/Value>
+#include <QtLua/NumericBuffer>
+#include <QtLua/QVectorProxy>
+#include <QtLua/QLinkedListProxy>
+#include <QtLua/QHashProxy>
+#include <QtLua/QMapProxy>
+#include <QtLua/RecordArrayProxy>
+#include <QtLua/DispatchProxy>
+#include <QtLua/MappedFileProxy>
+#include <QtLua/UserObject>
 
 using namespace QtLua;
 
+struct Sample
+{
+  double x;
+  double y;
+  int id;
+
+  QTLUA_RECORD(Sample)
+};
+
+QTLUA_RECORD_FIELDS(Sample,
+  QTLUA_RECORD_FIELD(Sample, x, double),
+  QTLUA_RECORD_FIELD(Sample, y, double),
+  QTLUA_RECORD_FIELD(Sample, id, int))
+
+// properties table is not sorted by name
+class Props : public UserObject<Props>
+{
+  QTLUA_USEROBJECT(Props);
+
+  QTLUA_PROPERTY(double, _zeta);
+  QTLUA_PROPERTY(double, _alpha);
+  QTLUA_PROPERTY_GET(double, _mid);
+  QTLUA_PROPERTY_SET(double, _beta);
+
+public:
+  Props()
+    : _zeta(1), _alpha(2), _mid(3), _beta(4)
+  {
+  }
+
+  double beta() const { return _beta; }
+};
+
+QTLUA_PROPERTIES_TABLE(Props,
+  QTLUA_PROPERTY_ENTRY(Props, "zeta", _zeta),
+  QTLUA_PROPERTY_ENTRY(Props, "alpha", _alpha),
+  QTLUA_PROPERTY_ENTRY_GET(Props, "mid", _mid),
+  QTLUA_PROPERTY_ENTRY_SET(Props, "beta", _beta)
+);
+
+typedef QMap<String, String> StringMap;
+
+// only reachable if a forced target class is not honored
+class Overlay : public QHashProxyRo<StringMap>
+{
+public:
+  Overlay(StringMap &m)
+    : QHashProxyRo<StringMap>(m)
+  {
+  }
+
+  Value meta_index(State &ls, const Value &key)
+  {
+    throw String("Overlay::meta_index called.");
+  }
+};
+
+// reports all keys but fails to read them
+class Thrower : public UserData
+{
+public:
+  Value meta_index(State &ls, const Value &key)
+  {
+    throw String("Thrower::meta_index called.");
+  }
+
+  bool meta_contains(State &ls, const Value &key)
+  {
+    return true;
+  }
+
+  bool support(Value::Operation c) const
+  {
+    return c == Value::OpIndex;
+  }
+};
+
 int main()
 {
   try {
@@ -79,6 +170,334 @@ int main()
     ASSERT(ls["r"]["c"].to_string() == "c_foobar");
   }
 
+  {
+    // buffer and array must outlive the State
+    double a[6] = { 1, 2, 3, 4, 5, 6 };
+    NumericBuffer<double> buf(a, 6);
+    QtLua::State ls;
+
+    ls["b"] = buf;
+
+    ASSERT(ls.exec_statements("return b:sum(), b:min(2, 4), b:max(), #b").at(0).to_number() == 21);
+    ASSERT(ls.exec_statements("return b:max(2, 4)").at(0).to_number() == 4);
+
+    // slices share memory with parent buffer
+    ls.exec_statements("s = b:slice(1, 6, 2); s:scale(10)");
+    ASSERT(a[0] == 10 && a[1] == 2 && a[2] == 30 && a[4] == 50);
+    ASSERT(ls.exec_statements("return #s, s:dot(s)").at(1).to_number() == 3500);
+
+    ls.exec_statements("b:add(1, 5, 6) b:map(function(v, i) return v + i end, 1, 2)");
+    ASSERT(a[0] == 11 && a[1] == 4 && a[5] == 7);
+  }
+
+  {
+    QVector<double> v(4);
+    QVectorProxy<QVector<double>, true> proxy(v);
+    QtLua::State ls;
+
+    ls["v"] = proxy;
+
+    ls.exec_statements("v:fill(7) v:assign(3, { 1, 2, 3 })");
+    ASSERT(v.size() == 5 && v[0] == 7 && v[2] == 1 && v[4] == 3);
+
+    // entries are converted before the vector is modified
+    bool err = false;
+    try {
+      ls.exec_statements("v:assign(4, { 5, 'x', 6 })");
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
+    ASSERT(v.size() == 5 && v[3] == 2 && v[4] == 3);
+
+    ASSERT(ls.exec_statements("t = v:slice(2, 3) return #t, t[1], t[2]").at(2).to_number() == 1);
+    ASSERT(ls.exec_statements("return #v:slice(4, 10)").at(0).to_number() == 2);
+  }
+
+  {
+    QVector<double> v;
+    QVectorProxy<QVector<double>, true> proxy(v);
+    QtLua::State ls;
+
+    ls["v"] = proxy;
+
+    ASSERT(ls.exec_statements("for i = 1, 1000 do v:push(i) end return v:push(1001, 1002)").at(0).to_number() == 1002);
+    ls.exec_statements("v:remove(1, 999) v:insert(2, 5, 6)");
+    ASSERT(v.size() == 5 && v[0] == 1000 && v[1] == 5 && v[2] == 6 && v[3] == 1001);
+
+    bool err = false;
+    try {
+      ls.exec_statements("v:insert(2, 7, 'x')");
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
+    ASSERT(v.size() == 5 && v[1] == 5 && v[2] == 6);
+    ls.exec_statements("v:clear()");
+    ASSERT(v.isEmpty());
+  }
+
+  {
+    QLinkedList<double> l;
+    QLinkedListProxy<QLinkedList<double> > proxy(l);
+    QLinkedList<double> c;
+    QLinkedListProxyRo<QLinkedList<double> > ro(c);
+    QtLua::State ls;
+
+    ls["l"] = proxy;
+
+    ASSERT(ls.exec_statements("for i = 1, 100 do l[i] = i end return #l").at(0).to_number() == 100);
+    ASSERT(ls.exec_statements("s = 0 for i = 1, #l do s = s + l[i] end return s").at(0).to_number() == 5050);
+    ASSERT(ls.exec_statements("return l[100], l[1], l[50], l[101]").at(2).to_number() == 50);
+
+    ls.exec_statements("l[50] = nil l[50] = l[50] * 2");
+    ASSERT(l.size() == 99 && ls.exec_statements("return l[49], l[50]").at(1).to_number() == 102);
+
+    // size changes from C++ drop cached position
+    l.removeFirst();
+    ASSERT(ls.exec_statements("return l[49]").at(0).to_number() == 102);
+    l.removeFirst();
+    l.append(7);
+    proxy.invalidate();
+    ASSERT(ls.exec_statements("return l[1], l[48], l[98]").at(1).to_number() == 102);
+    ASSERT(ls.exec_statements("return l[98]").at(0).to_number() == 7);
+
+    // lua reads do not share or copy the list data
+    ASSERT(l.isDetached());
+    QLinkedList<double>::iterator first = l.begin();
+    ASSERT(ls.exec_statements("return l[2]").at(0).to_number() == 4);
+    ASSERT(l.begin() == first);
+
+    // read only proxy does not detach shared list data
+    c = l;
+    ls["r"] = ro;
+    ASSERT(ls.exec_statements("return r[48]").at(0).to_number() == 102);
+    ASSERT(c.constBegin() == l.constBegin());
+  }
+
+  {
+    QMap<String, double> m;
+    QHashProxy<QMap<String, double> > proxy(m);
+    QtLua::State ls;
+
+    m["a"] = 1;
+    m["b"] = 2;
+    m["c"] = 3;
+    ls["m"] = proxy;
+
+    // value updates are allowed during iteration
+    ls.exec_statements("for k, v in each(m) do m[k] = v * 2 end");
+    ASSERT(m["a"] == 2 && m["c"] == 6);
+
+    bool err = false;
+    try {
+      ls.exec_statements("for k, v in each(m) do m.d = 4 end");
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err && m.size() == 4);
+
+    // snapshot iteration walks entries present when it started
+    proxy.set_snapshot_iteration(true);
+    ASSERT(ls.exec_statements("i = 0 for k, v in each(m) do m[k] = nil m[k..k] = v i = i + 1 end return i").at(0).to_integer() == 4);
+    ASSERT(m.size() == 4 && m["aa"] == 2 && !m.contains("a"));
+  }
+
+  {
+    QMap<double, double> m;
+    QMapProxy<QMap<double, double> > proxy(m);
+    QtLua::State ls;
+
+    for (int i = 0; i < 1000; i++)
+      m[i * 0.5] = i;
+    ls["m"] = proxy;
+
+    ASSERT(ls.exec_statements("s = 0 for k, v in each(m:range(10, 12)) do s = s + v end return s").at(0).to_number() == 20 + 21 + 22 + 23 + 24);
+    ASSERT(ls.exec_statements("i = 0 for k, v in each(m:from(499)) do i = i + 1 end return i").at(0).to_number() == 2);
+    ASSERT(ls.exec_statements("return m:first()").at(1).to_number() == 0);
+    ASSERT(ls.exec_statements("return m:last()").at(0).to_number() == 499.5);
+    ASSERT(ls.exec_statements("m[2] = nil return m[2], m[2.5]").at(1).to_number() == 5);
+    ASSERT(ls.exec_statements("i = 0 for k, v in each(m:range(12, 10)) do i = i + 1 end return i").at(0).to_number() == 0);
+  }
+
+  {
+    QMap<String, double> m;
+    QMapProxy<QMap<String, double> > proxy(m);
+    QtLua::State ls;
+
+    m["a"] = 1;
+    m["first"] = 2;
+    ls["m"] = proxy;
+
+    ASSERT(ls.exec_statements("return m.first, m.a").at(0).to_number() == 2);
+    ASSERT(ls.exec_statements("return m:last()").at(0).to_string() == "first");
+    ASSERT(ls.exec_statements("m.first = nil return m:first()").at(0).to_string() == "a");
+  }
+
+  {
+    QVector<Sample> v(10);
+    RecordArrayProxy<Sample> proxy(v);
+    QtLua::State ls;
+
+    for (int i = 0; i < v.size(); i++)
+      {
+	v[i].x = i;
+	v[i].y = 2 * i;
+	v[i].id = 0;
+      }
+
+    ls["r"] = proxy;
+
+    ASSERT(ls.exec_statements("r[3].id = 7 return #r, r[3].y").at(1).to_number() == 4);
+    ASSERT(v[2].id == 7);
+    ASSERT(ls.exec_statements("r:set(10, 'x', 5) return r:get(10, 'x')").at(0).to_number() == 5);
+    ASSERT(ls.exec_statements("return r:column('y'):sum()").at(0).to_number() == 90);
+    ls.exec_statements("r:column('x'):scale(2)");
+    ASSERT(v[1].x == 2 && v[9].x == 10 && v[1].y == 2);
+
+    v.resize(12);
+    v[11].id = 3;
+    ASSERT(ls.exec_statements("return #r, r[12].id").at(1).to_number() == 3);
+  }
+
+  {
+    QMap<String, String> m1, m2;
+    QHashProxyRo<QMap<String, String> > p1(m1);
+    QHashProxy<QMap<String, String> > p2(m2);
+    DispatchProxy dp;
+    QtLua::State ls;
+
+    m1["a"] = "1";
+    m2["b"] = "2";
+    dp.add_target(&p1);
+    dp.add_target(&p2);
+    dp.set_route_cache(true);
+    ls["d"] = dp;
+
+    ASSERT(ls.exec_statements("return d.a .. d.b .. d.b").at(0).to_string() == "122");
+    ls.exec_statements("d.c = 3 d.c = 4");
+    ASSERT(m2["c"] == "4");
+
+    // entry added to first target shadows the cached route
+    m1["b"] = "5";
+    dp.invalidate_routes();
+    ASSERT(ls.exec_statements("return d.b").at(0).to_string() == "5");
+
+    // route dropped on miss
+    m2["x"] = "6";
+    ASSERT(ls.exec_statements("return d.x").at(0).to_string() == "6");
+    m2.remove("x");
+    ASSERT(ls.exec_statements("return d.x").at(0).is_nil());
+    m1["x"] = "7";
+    m2["x"] = "8";
+    ASSERT(ls.exec_statements("return d.x").at(0).to_string() == "7");
+  }
+
+  {
+    StringMap m;
+    Overlay o(m);
+    Thrower t;
+    DispatchProxy dp;
+    QtLua::State ls;
+
+    m["a"] = "1";
+    dp.add_target(&t);
+    dp.add_target<QHashProxyRo<StringMap> >(&o);
+    ls["d"] = dp;
+
+    ASSERT(ls.exec_statements("return d.a").at(0).to_string() == "1");
+    ASSERT(ls.exec_statements("return d.b").at(0).is_nil());
+  }
+
+  {
+    QTemporaryFile f;
+
+    ASSERT(f.open());
+    f.write("HEAD", 4);
+    for (int i = 0; i < 100; i++)
+      {
+	struct { double t; qint32 v; qint32 pad; } r = { i * 0.5, i, 0 };
+	f.write((const char*)&r, sizeof(r));
+      }
+    f.close();
+
+    // file and proxy must outlive the State
+    MappedFileProxy proxy(f.fileName(), 16, 4);
+    QtLua::State ls;
+
+    proxy.add_field("t", 0, QMetaType::Double);
+    proxy.add_field("v", 8, QMetaType::Int);
+    ls["m"] = proxy;
+
+    ASSERT(ls.exec_statements("return #m, m[11].t, m[100].v, m[101]").at(2).to_number() == 99);
+    ASSERT(ls.exec_statements("return m[11].t").at(0).to_number() == 5);
+    ASSERT(ls.exec_statements("t = m:slice(3, 4) return #t, t[2].v").at(1).to_number() == 3);
+    ASSERT(ls.exec_statements("s = 0 for k, r in each(m) do s = s + r.v end return s").at(0).to_number() == 4950);
+
+    // non plain types and fields crossing record end are rejected
+    bool err = false;
+    try {
+      proxy.add_field("s", 0, QMetaType::QString);
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
+
+    err = false;
+    try {
+      proxy.add_field("d", 12, QMetaType::Double);
+    } catch (QtLua::String &e) {
+      err = true;
+    }
+    ASSERT(err);
+
+    proxy.close();
+  }
+
+  {
+    Props::ptr o = QTLUA_REFNEW(Props);
+    QtLua::State ls;
+
+    ls.openlib(QtLuaLib);
+    ls["o"] = o;
+
+    ASSERT(ls.exec_statements("return o.zeta").at(0).to_number() == 1);
+    ASSERT(ls.exec_statements("return o.alpha").at(0).to_number() == 2);
+    ASSERT(ls.exec_statements("return o.mid").at(0).to_number() == 3);
+
+    ls.exec_statements("o.alpha = 5 o.beta = 6");
+    ASSERT(ls.exec_statements("return o.alpha").at(0).to_number() == 5);
+    ASSERT(o->beta() == 6);
+
+    Value v(ls);
+    ASSERT(o->meta_contains(ls, Value(ls, "mid")));
+    ASSERT(o->meta_contains(ls, Value(ls, "beta")));
+    ASSERT(!o->meta_contains(ls, Value(ls, "gamma")));
+    ASSERT(!o->meta_contains(ls, Value(ls, 1)));
+    ASSERT(o->meta_find(ls, Value(ls, "zeta"), v) && v.to_number() == 1);
+    ASSERT(!o->meta_find(ls, Value(ls, "beta"), v));
+    ASSERT(!o->meta_find(ls, Value(ls, "a"), v));
+    ASSERT(!o->meta_find(ls, Value(ls, "zz"), v));
+
+    // iteration keeps the properties table order
+    ASSERT(ls.exec_statements("local s = '' for k, v in each(o) do s = s .. k .. ' ' "
+			      "if k == 'mid' then break end end return s")
+	   .at(0).to_string() == "zeta alpha mid ");
+
+    const char *bad[] = { "return o.gamma", "return o.beta", "o.mid = 1", "return o[1]", 0 };
+
+    for (int i = 0; bad[i]; i++)
+      {
+	bool err = false;
+	try {
+	  ls.exec_statements(bad[i]);
+	} catch (QtLua::String &e) {
+	  err = true;
+	}
+	ASSERT(err);
+      }
+  }
+
   } catch (QtLua::String &e) {
     std::cout << e.constData() << std::endl;
     ASSERT(0);
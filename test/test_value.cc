@@ -20,11 +20,60 @@
 
 #include "test.hh"
 
+#include <QPoint>
+#include <QRect>
+#include <QStringList>
+#include <QVariant>
+
 #include <QtLua/State>
 #include <QtLua/Value>
+#include <QtLua/Bind>
+#include <QtLua/ByteBuffer>
+#include <QtLua/MetaType>
 
 using namespace QtLua;
 
+static double bind_add(double a, int b)
+{
+  return a + b;
+}
+
+static String bind_cat(const String &a, const char *b)
+{
+  return a + b;
+}
+
+class BindObj : public UserData
+{
+public:
+  QTLUA_REFTYPE(BindObj);
+
+  BindObj() : _x(0) {}
+  double add(double a) { return _x += a; }
+  double get() const { return _x; }
+
+private:
+  double _x;
+};
+
+class BindOther : public UserData
+{
+public:
+  QTLUA_REFTYPE(BindOther);
+};
+
+QTLUA_METATYPE_ID(PointHandler, QPoint, QMetaType::QPoint);
+
+QtLua::Value PointHandler::qt2lua(QtLua::State &ls, QPoint const * qtvalue)
+{
+  return QtLua::Value(ls, String("%,%").arg(qtvalue->x()).arg(qtvalue->y()));
+}
+
+bool PointHandler::lua2qt(QPoint *qtvalue, const QtLua::Value &luavalue)
+{
+  return false;
+}
+
 int main()
 {
   try {
@@ -73,6 +122,74 @@ int main()
       ASSERT(res[5].to_string() == "hello");
     }
 
+    {
+      QtLua::State ls;
+      double n = 0;
+
+      ASSERT(Value(ls, 2.5).try_to_number(n) && n == 2.5);
+      ASSERT(Value(ls, "42").try_to_number(n) && n == 42);
+      ASSERT(!Value(ls, "foo").try_to_number(n) && n == 42);
+      ASSERT(!Value(ls).try_to_number(n));
+    }
+
+    {
+      QtLua::State ls;
+
+      bind(ls, "t.add", &bind_add);
+      bind(ls, "cat", &bind_cat);
+
+      ASSERT(ls.exec_statements("return t.add(1.5, 2)").at(0).to_number() == 3.5);
+      ASSERT(ls.exec_statements("return cat(\"foo\", 42)").at(0).to_string() == "foo42");
+    }
+
+    {
+      QtLua::State ls;
+      BindObj::ptr o = QTLUA_REFNEW(BindObj);
+
+      bind_method(ls, "add", &BindObj::add);
+      bind_method(ls, "get", &BindObj::get);
+      ls["o"] = o;
+      ls["b"] = QTLUA_REFNEW(BindOther);
+
+      ls.exec_statements("add(o, 2) add(o, 3)");
+      ASSERT(ls.exec_statements("return get(o)").at(0).to_number() == 5);
+      ASSERT(o->get() == 5);
+
+      // self is not counted in the expected argument count
+      bool err = false;
+      try {
+	ls.exec_statements("add(o)");
+      } catch (const QtLua::String &e) {
+	err = e.indexOf("1 arguments expected") >= 0;
+      }
+      ASSERT(err);
+
+      err = false;
+      try {
+	ls.exec_statements("get(o, 1)");
+      } catch (const QtLua::String &e) {
+	err = e.indexOf("0 arguments expected") >= 0;
+      }
+      ASSERT(err);
+
+      err = false;
+      try {
+	ls.exec_statements("add(1, 2)");
+      } catch (const QtLua::String &e) {
+	err = true;
+      }
+      ASSERT(err);
+
+      err = false;
+      try {
+	ls.exec_statements("add(b, 2)");
+      } catch (const QtLua::String &e) {
+	err = true;
+      }
+      ASSERT(err);
+      ASSERT(o->get() == 5);
+    }
+
     {
       QtLua::State ls;
 
@@ -117,6 +234,116 @@ int main()
       ASSERT(func(num).at(0).to_number() + 1.0f < 0.001f);
     }
 
+    {
+      QtLua::State ls;
+
+      {
+	// user handler is used instead of the built-in conversion
+	PointHandler h;
+
+	ls["p"] = Value(ls, QVariant(QPoint(10, 20)));
+	ASSERT(ls["p"].type() == Value::TString);
+	ASSERT(ls["p"].to_string() == "10,20");
+      }
+
+      ls["p"] = Value(ls, QVariant(QPoint(10, 20)));
+      ASSERT(ls["p"].type() == Value::TTable);
+    }
+
+    {
+      QtLua::State ls;
+
+      ls["t"] = Value(ls, QVariant(QRect(1, 2, 30, 40)));
+      ASSERT(ls["t"].type() == Value::TTable);
+
+      ls.set_conversions(State::ConvertValueTypes);
+
+      ls["r"] = Value(ls, QVariant(QRect(1, 2, 30, 40)));
+      ls["p"] = Value(ls, QVariant(QPoint(10, 20)));
+      ASSERT(ls["r"].type() == Value::TUserData);
+
+      ls.exec_statements("r.x = r.x + 4; s = r + p * 2");
+      ASSERT(ls["r"]["x"].to_number() == 5);
+      ASSERT(ls["r"]["width"].to_number() == 30);
+      ASSERT(ls["s"]["x"].to_number() == 25);
+      ASSERT(ls["s"]["y"].to_number() == 42);
+    }
+
+    {
+      QtLua::State ls;
+
+      ls.openlib(QtLuaLib);
+      ls.set_conversions(State::ConvertContainerViews);
+
+      ls["l"] = Value(ls, QVariant(QStringList() << "foo" << "bar"));
+      ASSERT(ls["l"].type() == Value::TUserData);
+
+      Value::List r = ls.exec_statements("t = to_table(l); return #l, l[2], type(t), t[1]");
+      ASSERT(r[0].to_number() == 2);
+      ASSERT(r[1].to_string() == "bar");
+      ASSERT(r[2].to_string() == "table");
+      ASSERT(r[3].to_string() == "foo");
+    }
+
+    {
+      QtLua::State ls;
+
+      ls.set_conversions(State::ConvertByteBuffers);
+
+      QByteArray a("hello world");
+      ls["b"] = Value(ls, QVariant(a));
+      ASSERT(ls["b"].type() == Value::TUserData);
+
+      Value::List r = ls.exec_statements("s = b:sub(7); return #b, b[1], b:find('o', 6), -s, b:byte(-1)");
+      ASSERT(r[0].to_number() == 11);
+      ASSERT(r[1].to_number() == 'h');
+      ASSERT(r[2].to_number() == 8);
+      ASSERT(r[3].to_string() == "world");
+      ASSERT(r[4].to_number() == 'd');
+
+      QByteArray c;
+      ASSERT(ByteBuffer::get(ls["b"], c) && c.constData() == a.constData());
+      ASSERT(ByteBuffer::get(ls["s"], c) && c == "world");
+    }
+
+    {
+      QtLua::State ls;
+
+      ls.exec_statements("t = { 1, 2, { a = 'x', b = true } }; c = { }; c.self = c");
+
+      QVariant v = ls.get_global("t").to_qvariant();
+      QVariantList l = v.toList();
+      ASSERT(l.size() == 3);
+      ASSERT(l[1].toDouble() == 2);
+      ASSERT(l[2].toMap()["a"].toString() == "x");
+      ASSERT(l[2].toMap()["b"].toBool());
+
+      ls["u"] = Value(ls, v);
+      ASSERT(ls.exec_statements("return u[3].a").at(0).to_string() == "x");
+
+      bool cycle = false;
+      try {
+	ls.get_global("c").to_qvariant();
+      } catch (const QtLua::String &e) {
+	cycle = true;
+      }
+      ASSERT(cycle);
+      ASSERT(ls.exec_statements("return c.self == c").at(0).to_boolean());
+    }
+
+    {
+      QtLua::State ls;
+
+      ls.exec_statements("t = { a = 1, [1234567] = 2, [1234568] = 3, [0.5] = 4, [-3] = 5 }");
+
+      QVariantMap m = ls.get_global("t").to_qvariant().toMap();
+      ASSERT(m.size() == 5);
+      ASSERT(m["1234567"].toDouble() == 2);
+      ASSERT(m["1234568"].toDouble() == 3);
+      ASSERT(m["0.5"].toDouble() == 4);
+      ASSERT(m["-3"].toDouble() == 5);
+    }
+
   } catch (QtLua::String &e) {
     std::cout << e.constData() << std::endl;
     ASSERT(0);
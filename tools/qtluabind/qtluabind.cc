@@ -0,0 +1,409 @@
+/*
+    This file is part of LibQtLua.
+
+    LibQtLua is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LibQtLua is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with LibQtLua.  If not, see <http://www.gnu.org/licenses/>.
+
+    Copyright (C) 2008, Alexandre Becoulet <alexandre.becoulet@free.fr>
+
+*/
+
+/*
+  Lua binding generator for UserData based classes. Reads a C++
+  header where classes are marked with QTLUA_BIND_CLASS and members
+  with QTLUA_BIND or QTLUA_BIND_RO, writes C++ code defining the
+  table access functions declared by QTLUA_BIND_CLASS.
+*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include <QFile>
+#include <QList>
+#include <QRegExp>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include "config.hh"
+
+struct BindMember
+{
+  enum Kind
+    {
+      Field,
+      Method,
+      StaticMethod,
+    };
+
+  QString _name;
+  Kind _kind;
+  bool _read_only;
+
+  bool operator<(const BindMember &m) const
+  {
+    return _name < m._name;
+  }
+};
+
+struct BindClass
+{
+  /** class name, may be qualified */
+  QString _name;
+  /** position of class body braces in source */
+  int _begin;
+  int _end;
+  QList<BindMember> _members;
+};
+
+static QString input_name;
+
+static void error(const QString &msg)
+{
+  std::cerr << "qtluabind: " << input_name.toLocal8Bit().constData()
+	    << ": " << msg.toLocal8Bit().constData() << std::endl;
+  std::exit(1);
+}
+
+static QString clean_source(const QString &text)
+{
+  QString res(text);
+
+  res.replace(QRegExp("//[^\n]*"), " ");
+
+  QRegExp c("/\\*.*\\*/");
+  c.setMinimal(true);
+  res.replace(c, " ");
+
+  // preprocessor directives, with continued lines
+  res.replace(QRegExp("(^|\n)[ \t]*#([^\n]*\\\\\n)*[^\n]*"), "\n");
+
+  return res;
+}
+
+// parse member declaration following a QTLUA_BIND annotation
+static BindMember parse_member(const QString &decl)
+{
+  BindMember m;
+  int paren = decl.indexOf('(');
+
+  m._read_only = false;
+
+  if (paren >= 0)
+    {
+      QRegExp name("(\\w+)\\s*$");
+
+      if (name.indexIn(decl.left(paren)) < 0)
+	error(QString("can not parse member function declaration `%1'").arg(decl));
+
+      m._name = name.cap(1);
+      m._kind = QRegExp("\\bstatic\\b").indexIn(decl) >= 0
+	? BindMember::StaticMethod : BindMember::Method;
+
+      if (QRegExp("\\boperator\\b").indexIn(decl) >= 0)
+	error(QString("operators can not be bound `%1'").arg(decl));
+    }
+  else
+    {
+      QString d(decl.section('=', 0, 0));
+      d.remove(QRegExp("\\[[^\\]]*\\]"));
+
+      QRegExp name("(\\w+)\\s*$");
+
+      if (name.indexIn(d) < 0)
+	error(QString("can not parse data member declaration `%1'").arg(decl));
+
+      if (QRegExp("\\bstatic\\b").indexIn(decl) >= 0)
+	error(QString("static data members can not be bound `%1'").arg(decl));
+
+      m._name = name.cap(1);
+      m._kind = BindMember::Field;
+    }
+
+  return m;
+}
+
+// find the unmatched opening brace before pos
+static int enclosing_brace(const QString &text, int pos)
+{
+  int depth = 0;
+
+  while (--pos >= 0)
+    {
+      if (text[pos] == '}')
+	depth++;
+      else if (text[pos] == '{' && depth-- == 0)
+	return pos;
+    }
+
+  return -1;
+}
+
+static int matching_brace(const QString &text, int open)
+{
+  int depth = 0;
+
+  for (int pos = open; pos < text.size(); pos++)
+    {
+      if (text[pos] == '{')
+	depth++;
+      else if (text[pos] == '}' && --depth == 0)
+	return pos;
+    }
+
+  return -1;
+}
+
+static QList<BindClass> parse(const QString &text)
+{
+  QList<BindClass> classes;
+  QRegExp crx("\\bQTLUA_BIND_CLASS\\s*\\(\\s*(\\w+(?:\\s*::\\s*\\w+)*)\\s*\\)");
+  int pos = 0;
+
+  // first pass, find annotated class bodies
+  while ((pos = crx.indexIn(text, pos)) >= 0)
+    {
+      BindClass c;
+      c._name = crx.cap(1).remove(QRegExp("\\s"));
+      c._begin = enclosing_brace(text, pos);
+
+      if (c._begin < 0)
+	error(QString("QTLUA_BIND_CLASS(%1) found outside of a class body").arg(c._name));
+
+      c._end = matching_brace(text, c._begin);
+
+      if (c._end < 0)
+	error(QString("unterminated `%1' class body").arg(c._name));
+
+      classes.append(c);
+      pos += crx.matchedLength();
+    }
+
+  // second pass, attach members to the innermost annotated class
+  QRegExp rx("\\b(QTLUA_BIND_RO|QTLUA_BIND)\\b");
+  pos = 0;
+
+  while ((pos = rx.indexIn(text, pos)) >= 0)
+    {
+      int start = pos;
+      pos += rx.matchedLength();
+
+      BindClass *cp = 0;
+
+      for (int i = 0; i < classes.size(); i++)
+	if (classes[i]._begin < start && start < classes[i]._end &&
+	    (!cp || classes[i]._begin > cp->_begin))
+	  cp = &classes[i];
+
+      if (!cp)
+	error("QTLUA_BIND annotation found outside of a QTLUA_BIND_CLASS class");
+
+      int end = text.indexOf(QRegExp("[;{]"), pos);
+
+      if (end < 0)
+	error("unterminated member declaration");
+
+      BindMember m = parse_member(text.mid(pos, end - pos).simplified());
+      m._read_only = rx.cap(1) == "QTLUA_BIND_RO";
+
+      BindClass &c = *cp;
+
+      foreach (const BindMember &n, c._members)
+	if (n._name == m._name)
+	  error(QString("`%1::%2' is declared twice, overloaded functions are not supported")
+		.arg(c._name).arg(m._name));
+
+      c._members.append(m);
+      pos = end;
+    }
+
+  return classes;
+}
+
+static void generate(QTextStream &out, const BindClass &c)
+{
+  QList<BindMember> members(c._members);
+  const QString &n = c._name;
+  // identifier prefix for generated static data
+  QString id = QString("qtlua_bind_") + QString(n).replace("::", "_");
+
+  qSort(members);
+
+  out << "/* " << n << " */\n\n";
+
+  out << "static const char * const " << id << "_names[] = {\n";
+  foreach (const BindMember &m, members)
+    out << "  \"" << m._name << "\",\n";
+  out << "  0\n};\n\n";
+
+  // address used as registry key of the members table
+  out << "static char " << id << "_key;\n\n";
+
+  QString lookup = QString("QtLua::BindBase::lookup(%1_names, %2, key)")
+    .arg(id).arg(members.size());
+
+  // methods registration
+  out << "void " << n << "::qtlua_register(QtLua::State &ls)\n{\n";
+  foreach (const BindMember &m, members)
+    if (m._kind != BindMember::Field)
+      out << "  QtLua::bind_member(ls, &" << id << "_key, \"" << m._name << "\", &"
+	  << n << "::" << m._name << ");\n";
+  out << "}\n\n";
+
+  // read access
+  out << "bool " << n << "::meta_find(QtLua::State &ls, const QtLua::Value &key, QtLua::Value &value)\n{\n"
+      << "  switch (" << lookup << ")\n"
+      << "    {\n";
+
+  for (int i = 0; i < members.size(); i++)
+    {
+      const BindMember &m = members[i];
+
+      out << "    case " << i << ":\t/* " << m._name << " */\n";
+
+      if (m._kind == BindMember::Field)
+	out << "      value = QtLua::Value(ls, " << m._name << ");\n";
+      else
+	out << "      if (!QtLua::BindBase::find_class_member(ls, &" << id << "_key, key, value))\n"
+	    << "        return false;\n"
+	    << "      meta_index_cache(ls, key, value);\n";
+
+      out << "      return true;\n";
+    }
+
+  out << "    default:\n"
+      << "      return false;\n"
+      << "    }\n"
+      << "}\n\n";
+
+  out << "QtLua::Value " << n << "::meta_index(QtLua::State &ls, const QtLua::Value &key)\n{\n"
+      << "  QtLua::Value value(ls);\n\n"
+      << "  if (!meta_find(ls, key, value))\n"
+      << "    throw QtLua::String(\"No such member `" << n << "::%'\").arg(key.to_string_p(false));\n\n"
+      << "  return value;\n"
+      << "}\n\n";
+
+  out << "bool " << n << "::meta_contains(QtLua::State &ls, const QtLua::Value &key)\n{\n"
+      << "  return " << lookup << " >= 0;\n"
+      << "}\n\n";
+
+  // write access
+  out << "void " << n << "::meta_newindex(QtLua::State &ls, const QtLua::Value &key, const QtLua::Value &value)\n{\n"
+      << "  switch (" << lookup << ")\n"
+      << "    {\n";
+
+  for (int i = 0; i < members.size(); i++)
+    {
+      const BindMember &m = members[i];
+
+      if (m._kind != BindMember::Field || m._read_only)
+	continue;
+
+      out << "    case " << i << ":\t/* " << m._name << " */\n"
+	  << "      " << m._name << " = value;\n"
+	  << "      return;\n";
+    }
+
+  out << "    case -1:\n"
+      << "      throw QtLua::String(\"No such member `" << n << "::%'\").arg(key.to_string_p(false));\n"
+      << "    default:\n"
+      << "      throw QtLua::String(\"The `" << n << "::%' member is read only\").arg(key.to_string_p(false));\n"
+      << "    }\n"
+      << "}\n\n";
+
+  out << "bool " << n << "::support(QtLua::Value::Operation c) const\n{\n"
+      << "  switch (c)\n"
+      << "    {\n"
+      << "    case QtLua::Value::OpIndex:\n"
+      << "    case QtLua::Value::OpNewindex:\n"
+      << "      return true;\n"
+      << "    default:\n"
+      << "      return false;\n"
+      << "    }\n"
+      << "}\n\n";
+}
+
+static void usage()
+{
+  std::cerr
+    << "QtLua binding generator " PACKAGE_VERSION << std::endl
+    << "usage: qtluabind [-o output.cc] [-i include_name] header.hh" << std::endl;
+  std::exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  QString output, include;
+
+  for (int i = 1; i < argc; i++)
+    {
+      QByteArray arg(argv[i]);
+
+      if (arg == "-o" && i + 1 < argc)
+	output = QString::fromLocal8Bit(argv[++i]);
+      else if (arg == "-i" && i + 1 < argc)
+	include = QString::fromLocal8Bit(argv[++i]);
+      else if (arg[0] == '-' || !input_name.isEmpty())
+	usage();
+      else
+	input_name = QString::fromLocal8Bit(arg);
+    }
+
+  if (input_name.isEmpty())
+    usage();
+
+  if (include.isEmpty())
+    include = input_name;
+
+  QFile in(input_name);
+
+  if (!in.open(QIODevice::ReadOnly))
+    error("unable to open file");
+
+  QList<BindClass> classes = parse(clean_source(QString::fromLocal8Bit(in.readAll())));
+
+  if (classes.isEmpty())
+    error("no QTLUA_BIND_CLASS found");
+
+  QFile out_file;
+
+  if (output.isEmpty())
+    out_file.open(stdout, QIODevice::WriteOnly);
+  else
+    {
+      out_file.setFileName(output);
+      if (!out_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+	  input_name = output;
+	  error("unable to create file");
+	}
+    }
+
+  QTextStream out(&out_file);
+
+  out << "/*\n"
+      << "  Lua bindings generated by qtluabind " PACKAGE_VERSION " from `" << input_name << "'.\n"
+      << "  Do not edit, changes will be lost.\n"
+      << "*/\n\n"
+      << "#include <QtLua/State>\n"
+      << "#include <QtLua/Value>\n"
+      << "#include <QtLua/String>\n"
+      << "#include <QtLua/Bind>\n\n"
+      << "#include \"" << include << "\"\n\n";
+
+  foreach (const BindClass &c, classes)
+    generate(out, c);
+
+  return 0;
+}
+